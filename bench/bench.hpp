@@ -0,0 +1,84 @@
+#ifndef KSR_BENCH_BENCH_HPP
+#define KSR_BENCH_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ksr { namespace bench {
+
+    ///
+    /// Prevents the compiler from discarding the computation of \p value as dead code, without
+    /// otherwise constraining how that computation is optimised.
+    ///
+
+    template <typename t>
+    inline void do_not_optimise(const t& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    ///
+    /// Passed to each benchmark function; measure() times a body over a number of iterations and
+    /// reports the mean cost of each (or of each of \p items_per_iteration items, for bodies that
+    /// process a batch per call). Benchmarks typically call measure() several times to compare
+    /// variants of the same operation.
+    ///
+
+    class context {
+    public:
+
+        template <typename body_t>
+        void measure(
+            const std::string& label, const std::size_t iterations, body_t body,
+            const std::size_t items_per_iteration = 1) {
+
+            // One untimed iteration warms caches and branch predictors and faults in any lazily
+            // allocated memory, so that the timed run measures the steady state.
+
+            body();
+
+            const auto start = std::chrono::steady_clock::now();
+            for (auto i = std::size_t{0}; i < iterations; ++i) {
+                body();
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            const auto ns = std::chrono::duration<double, std::nano>{elapsed}.count();
+            const auto items = static_cast<double>(iterations) * static_cast<double>(items_per_iteration);
+            std::printf("  %-48s %12.2f ns/%s\n",
+                label.c_str(), ns / items, items_per_iteration == 1 ? "iter" : "item");
+        }
+    };
+
+    using benchmark_fn = void (*)(context&);
+
+    inline auto registry() -> std::vector<std::pair<const char*, benchmark_fn>>& {
+        static auto instance = std::vector<std::pair<const char*, benchmark_fn>>{};
+        return instance;
+    }
+
+    struct registrar {
+        registrar(const char* const name, const benchmark_fn fn) {
+            registry().emplace_back(name, fn);
+        }
+    };
+}}
+
+#define KSR_BENCH_CONCAT_(lhs, rhs) lhs##rhs
+#define KSR_BENCH_CONCAT(lhs, rhs) KSR_BENCH_CONCAT_(lhs, rhs)
+
+///
+/// Defines and registers a benchmark function named \p name, which receives a
+/// <tt>ksr::bench::context& ctx</tt> parameter (in the manner of Catch's \c TEST_CASE).
+///
+
+#define KSR_BENCHMARK(name) \
+    static void KSR_BENCH_CONCAT(ksr_bench_, name)(ksr::bench::context& ctx); \
+    static const ksr::bench::registrar KSR_BENCH_CONCAT(ksr_bench_registrar_, name){ \
+        #name, &KSR_BENCH_CONCAT(ksr_bench_, name)}; \
+    static void KSR_BENCH_CONCAT(ksr_bench_, name)([[maybe_unused]] ksr::bench::context& ctx)
+
+#endif
@@ -0,0 +1,351 @@
+#include "bench.hpp"
+
+#include "ksr/algorithm.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace ksr;
+
+namespace {
+
+    constexpr auto lookup_count = std::size_t{1000};
+
+    // Looks up a spread of present and absent values (the even ones are present).
+
+    template <typename lookup_t>
+    void measure_lookups(bench::context& ctx, const std::string& label, const int size, lookup_t lookup) {
+
+        auto found = std::size_t{0};
+        const auto iterations = std::max(std::size_t{1}, std::size_t{2000000} / (lookup_count * static_cast<std::size_t>(size)));
+
+        ctx.measure(label, iterations, [&] {
+            for (auto i = std::size_t{0}; i < lookup_count; ++i) {
+                found += lookup(static_cast<int>(i * 7919 % static_cast<std::size_t>(2 * size)));
+            }
+        }, lookup_count);
+
+        bench::do_not_optimise(found);
+    }
+}
+
+KSR_BENCHMARK(algorithm_contains) {
+
+    for (const auto size : {16, 1024, 65536}) {
+
+        auto sorted = std::vector<int>{};
+        for (auto i = 0; i < size; ++i) {
+            sorted.push_back(2 * i);
+        }
+
+        const auto set = std::set<int>(sorted.begin(), sorted.end());
+        const auto unordered = std::unordered_set<int>(sorted.begin(), sorted.end());
+        const auto suffix = " (n = " + std::to_string(size) + ")";
+
+        measure_lookups(ctx, "std::find over set" + suffix, size, [&](const int value) {
+            return std::find(set.begin(), set.end(), value) != set.end();
+        });
+        measure_lookups(ctx, "contains(set)" + suffix, size, [&](const int value) {
+            return contains(set, value);
+        });
+        measure_lookups(ctx, "contains(unordered_set)" + suffix, size, [&](const int value) {
+            return contains(unordered, value);
+        });
+        measure_lookups(ctx, "contains(sorted vector)" + suffix, size, [&](const int value) {
+            return contains(sorted, value);
+        });
+        measure_lookups(ctx, "contains_sorted(sorted vector)" + suffix, size, [&](const int value) {
+            return contains_sorted(sorted, value);
+        });
+    }
+}
+
+namespace {
+
+    // Searches for an absent value, so that each search scans the whole range.
+
+    template <typename t>
+    void measure_scan(bench::context& ctx, const char* const type_name, const std::size_t size) {
+
+        const auto values = std::vector<t>(size, t{1});
+        const auto iterations = std::max(std::size_t{10}, std::size_t{50000000} / size);
+        const auto suffix = std::string{type_name} + ", n = " + std::to_string(size) + ")";
+        auto found = std::size_t{0};
+
+        ctx.measure("std::find (" + suffix, iterations, [&] {
+            found += std::find(values.begin(), values.end(), t{2}) != values.end();
+        }, size);
+
+        // The memory clobber stops the compiler from hoisting memchr() (which it knows to be pure)
+        // out of the timing loop.
+
+        ctx.measure("contains (" + suffix, iterations, [&] {
+            bench::do_not_optimise(values.data());
+            found += contains(values, t{2});
+        }, size);
+
+        bench::do_not_optimise(found);
+    }
+}
+
+KSR_BENCHMARK(algorithm_contains_scan) {
+
+    for (const auto size : {std::size_t{64}, std::size_t{4096}, std::size_t{1} << 20}) {
+        measure_scan<std::uint8_t>(ctx, "uint8_t", size);
+        measure_scan<std::uint16_t>(ctx, "uint16_t", size);
+        measure_scan<std::uint32_t>(ctx, "uint32_t", size);
+        measure_scan<std::uint64_t>(ctx, "uint64_t", size);
+    }
+}
+
+KSR_BENCHMARK(algorithm_contains_each) {
+
+    // Which of m IDs occur in a range of a million (of which every third is present)? The
+    // IDs are generated in an order that wraps around once; the same IDs are also searched
+    // sorted, shuffled and in a list.
+
+    auto haystack = std::vector<std::uint32_t>{};
+    for (auto i = std::uint32_t{0}; i < 1000000; ++i) {
+        haystack.push_back(i * 7919);
+    }
+
+    auto sorted = haystack;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto shuffled = haystack;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937{42});
+
+    const auto sorted_list = std::list<std::uint32_t>(sorted.begin(), sorted.end());
+
+    for (const auto needle_count : {std::size_t{4}, std::size_t{100}, std::size_t{10000}}) {
+
+        auto needles = std::vector<std::uint32_t>{};
+        for (auto i = std::size_t{0}; i < needle_count; ++i) {
+            needles.push_back(static_cast<std::uint32_t>(i * 3 * 7919 / 2));
+        }
+
+        const auto suffix = " (m = " + std::to_string(needle_count) + ")";
+        auto found = std::size_t{0};
+
+        if (needle_count <= 100) {
+            ctx.measure("contains in a loop" + suffix, 5, [&] {
+                for (const auto needle : needles) {
+                    found += contains(haystack, needle);
+                }
+            });
+        }
+
+        ctx.measure("count_contained" + suffix, 5, [&] {
+            found += count_contained(haystack, needles);
+        });
+
+        ctx.measure("count_contained, sorted" + suffix, 5, [&] {
+            found += count_contained(sorted, needles);
+        });
+
+        ctx.measure("count_contained, shuffled" + suffix, 5, [&] {
+            found += count_contained(shuffled, needles);
+        });
+
+        ctx.measure("count_contained, sorted list" + suffix, 5, [&] {
+            found += count_contained(sorted_list, needles);
+        });
+
+        bench::do_not_optimise(found);
+    }
+}
+
+namespace {
+
+    constexpr auto erase_size = 10000;
+
+    // Erasure by calling erase() for each element, as erase_if() once did for every container.
+
+    template <typename container_t, typename pred_t>
+    auto erase_each(container_t& container, pred_t pred) -> std::size_t {
+
+        auto erased = std::size_t{0};
+        auto iter = container.begin();
+        while (iter != container.end()) {
+            if (pred(*iter)) {
+                iter = container.erase(iter);
+                ++erased;
+            } else {
+                ++iter;
+            }
+        }
+
+        return erased;
+    }
+
+    // Each iteration erases from a fresh copy, so the copy is measured too, as a baseline.
+
+    template <typename container_t>
+    void measure_erase(bench::context& ctx, const char* const type_name, const int percent) {
+
+        auto source = container_t{};
+        for (auto i = 0; i < erase_size; ++i) {
+            source.insert(source.end(), i);
+        }
+
+        const auto pred = [=](const int value) { return value * 7919 % 100 < percent; };
+        const auto suffix = std::string{" ("} + type_name + ", " + std::to_string(percent) + "% erased)";
+        const auto iterations = std::size_t{200};
+        auto erased = std::size_t{0};
+
+        ctx.measure("copy only" + suffix, iterations, [&] {
+            auto container = source;
+            erased += container.size();
+        }, erase_size);
+
+        // Erasing half of a sequence element by element is quadratic, so is only measured for a
+        // few percent, where it is merely slow.
+
+        constexpr auto is_sequence =
+            std::is_same_v<container_t, std::vector<int>> || std::is_same_v<container_t, std::deque<int>>;
+
+        if (!is_sequence || percent <= 10) {
+            ctx.measure("erase each" + suffix, iterations, [&] {
+                auto container = source;
+                erased += erase_each(container, pred);
+            }, erase_size);
+        }
+
+        ctx.measure("erase_if" + suffix, iterations, [&] {
+            auto container = source;
+            erased += ksr::erase_if(container, pred);
+        }, erase_size);
+
+        if constexpr (is_sequence) {
+            ctx.measure("erase_if_unstable" + suffix, iterations, [&] {
+                auto container = source;
+                erased += erase_if_unstable(container, pred);
+            }, erase_size);
+        }
+
+        bench::do_not_optimise(erased);
+    }
+}
+
+KSR_BENCHMARK(algorithm_erase_if) {
+
+    for (const auto percent : {1, 10, 50}) {
+        measure_erase<std::vector<int>>(ctx, "vector", percent);
+        measure_erase<std::deque<int>>(ctx, "deque", percent);
+        measure_erase<std::list<int>>(ctx, "list", percent);
+        measure_erase<std::set<int>>(ctx, "set", percent);
+    }
+}
+
+namespace {
+
+    // The enumeration that k_permute() once used, which permutes the whole range for each
+    // partial permutation.
+
+    template <typename callback_t>
+    void k_permute_by_next_permutation(std::vector<int>& values, const std::size_t k, callback_t callback) {
+
+        const auto mid = values.begin() + static_cast<std::ptrdiff_t>(k);
+        do {
+            callback(values.begin(), mid);
+            std::reverse(mid, values.end());
+        } while (std::next_permutation(values.begin(), values.end()));
+    }
+
+    auto partial_permutation_count(const std::size_t n, const std::size_t k) -> std::size_t {
+
+        auto count = std::size_t{1};
+        for (auto i = n - k + 1; i <= n; ++i) {
+            count *= i;
+        }
+        return count;
+    }
+}
+
+KSR_BENCHMARK(algorithm_k_permute) {
+
+    const auto shapes = {
+        std::pair{std::size_t{8}, std::size_t{8}},
+        std::pair{std::size_t{9}, std::size_t{8}},
+        std::pair{std::size_t{10}, std::size_t{5}},
+        std::pair{std::size_t{20}, std::size_t{3}},
+        std::pair{std::size_t{200}, std::size_t{2}},
+        std::pair{std::size_t{2000}, std::size_t{1}}};
+
+    for (const auto& [n, k] : shapes) {
+
+        auto values = std::vector<int>(n);
+        for (auto i = std::size_t{0}; i < n; ++i) {
+            values[i] = static_cast<int>(i);
+        }
+
+        const auto count = partial_permutation_count(n, k);
+        const auto iterations = std::max(std::size_t{1}, std::size_t{2000000} / count);
+        const auto suffix = " (n = " + std::to_string(n) + ", k = " + std::to_string(k) + ")";
+        auto sum = 0;
+
+        const auto callback = [&sum](const auto begin, const auto end) {
+            sum += begin == end ? 0 : *begin;
+        };
+
+        ctx.measure("reverse + next_permutation" + suffix, iterations, [&] {
+            k_permute_by_next_permutation(values, k, callback);
+        }, count);
+
+        ctx.measure("k_permute" + suffix, iterations, [&] {
+            k_permute(values, k, callback);
+        }, count);
+
+        bench::do_not_optimise(sum);
+    }
+}
+
+KSR_BENCHMARK(algorithm_sub_permute) {
+
+    for (const auto n : {std::size_t{6}, std::size_t{9}}) {
+
+        auto values = std::vector<int>(n);
+        for (auto i = std::size_t{0}; i < n; ++i) {
+            values[i] = static_cast<int>(i);
+        }
+
+        auto count = std::size_t{0};
+        for (auto k = std::size_t{0}; k <= n; ++k) {
+            count += partial_permutation_count(n, k);
+        }
+
+        const auto iterations = std::max(std::size_t{1}, std::size_t{2000000} / count);
+        const auto suffix = " (n = " + std::to_string(n) + ")";
+        auto sum = 0;
+
+        const auto callback = [&sum](const auto begin, const auto end) {
+            sum += begin == end ? 0 : *begin;
+        };
+
+        ctx.measure("reverse + next_permutation for each k" + suffix, iterations, [&] {
+            for (auto k = std::size_t{0}; k <= n; ++k) {
+                k_permute_by_next_permutation(values, k, callback);
+            }
+        }, count);
+
+        ctx.measure("sub_permute (by size)" + suffix, iterations, [&] {
+            sub_permute(values, sub_permute_order::by_size, callback);
+        }, count);
+
+        ctx.measure("sub_permute (prefix tree)" + suffix, iterations, [&] {
+            sub_permute(values, sub_permute_order::prefix_tree, callback);
+        }, count);
+
+        bench::do_not_optimise(sum);
+    }
+}
@@ -0,0 +1,89 @@
+#include "bench.hpp"
+
+#include "ksr/concurrent_update_filter.hpp"
+#include "ksr/update_filter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ksr;
+
+namespace {
+
+    constexpr auto updates_per_thread = 1000000L;
+
+    template <typename update_fn_t>
+    void run_threads(const int thread_count, update_fn_t update_fn) {
+
+        auto next = std::atomic<long>{0};
+        const auto total = updates_per_thread * thread_count;
+
+        auto threads = std::vector<std::thread>{};
+        for (auto i = 0; i < thread_count; ++i) {
+            threads.emplace_back([&] {
+
+                // Each worker claims items in small batches, as a real worker pool would; the
+                // batch counter stays off the filter's cache lines.
+
+                static constexpr auto batch = 64L;
+                for (auto begin = next.fetch_add(batch); begin < total; begin = next.fetch_add(batch)) {
+                    for (auto count = begin; count < begin + batch; ++count) {
+                        update_fn(count, total);
+                    }
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    auto thread_counts() -> std::vector<int> {
+
+        const auto max = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+        auto result = std::vector<int>{};
+        for (auto count = 1; count < max; count *= 2) {
+            result.push_back(count);
+        }
+        result.push_back(max);
+        return result;
+    }
+}
+
+KSR_BENCHMARK(concurrent_update_filter_contention) {
+
+    for (const auto thread_count : thread_counts()) {
+
+        const auto items = static_cast<std::size_t>(updates_per_thread * thread_count);
+        const auto suffix = " (" + std::to_string(thread_count) + " threads)";
+        auto updates = std::atomic<long>{0};
+
+        ctx.measure("mutex + int_percentage_filter" + suffix, 3, [&] {
+
+            auto mutex = std::mutex{};
+            auto filter = int_percentage_filter<long>{[&](long, long) { ++updates; }};
+
+            run_threads(thread_count, [&](const long count, const long total) {
+                const auto lock = std::lock_guard{mutex};
+                filter.update(count, total);
+            });
+        }, items);
+
+        ctx.measure("concurrent_int_percentage_filter" + suffix, 3, [&] {
+
+            auto filter = concurrent_int_percentage_filter<long>{[&](long, long) { ++updates; }};
+
+            run_threads(thread_count, [&](const long count, const long total) {
+                filter.update(count, total);
+            });
+        }, items);
+
+        bench::do_not_optimise(updates);
+    }
+}
@@ -0,0 +1,89 @@
+#include "bench.hpp"
+
+#include "ksr/filter_bank.hpp"
+#include "ksr/update_filter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace ksr;
+
+namespace {
+
+    constexpr auto filter_count = std::size_t{50000};
+    constexpr auto total = std::int64_t{100000000};
+
+    // Every filter advances by a small step per round, so that (as for per-file progress) only a
+    // small fraction of them fire in any one round.
+
+    auto make_counts() -> std::vector<std::int64_t> {
+        return std::vector<std::int64_t>(filter_count, 0);
+    }
+
+    void advance(std::vector<std::int64_t>& counts) {
+        for (auto& count : counts) {
+            count += 97;
+        }
+    }
+}
+
+KSR_BENCHMARK(filter_bank_update) {
+
+    auto fired_total = std::size_t{0};
+
+    {
+        // Separately allocated filters, as when each is owned by the object tracking its file.
+
+        auto filters = std::vector<std::unique_ptr<int_percentage_filter<std::int64_t>>>{};
+        for (auto i = std::size_t{0}; i < filter_count; ++i) {
+            filters.push_back(std::make_unique<int_percentage_filter<std::int64_t>>(
+                [&](std::int64_t, std::int64_t) { ++fired_total; }));
+        }
+
+        auto counts = make_counts();
+        ctx.measure("individual int_percentage_filters", 200, [&] {
+            advance(counts);
+            for (auto i = std::size_t{0}; i < filter_count; ++i) {
+                filters[i]->update(counts[i], total);
+            }
+        }, filter_count);
+    }
+
+    auto bank = int_percentage_filter_bank<>{};
+    for (auto i = std::size_t{0}; i < filter_count; ++i) {
+        bank.add(total);
+    }
+
+    {
+        auto counts = make_counts();
+        auto bitmap = filter_bank_bitmap{};
+        ctx.measure("int_percentage_filter_bank dense", 200, [&] {
+            advance(counts);
+            fired_total += bank.update(0, counts.data(), counts.data() + counts.size(), bitmap);
+        }, filter_count);
+    }
+
+    {
+        auto ids = std::vector<std::size_t>(filter_count);
+        for (auto i = std::size_t{0}; i < filter_count; ++i) {
+            ids[i] = i;
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937{42});
+
+        auto counts = make_counts();
+        auto fired = std::vector<std::size_t>{};
+        ctx.measure("int_percentage_filter_bank sparse (shuffled ids)", 200, [&] {
+            advance(counts);
+            fired.clear();
+            bank.update(ids.begin(), ids.end(), counts.begin(), std::back_inserter(fired));
+            fired_total += fired.size();
+        }, filter_count);
+    }
+
+    bench::do_not_optimise(fired_total);
+}
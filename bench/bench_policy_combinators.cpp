@@ -0,0 +1,101 @@
+#include "bench.hpp"
+
+#include "ksr/clock.hpp"
+#include "ksr/math.hpp"
+#include "ksr/policy_combinators.hpp"
+#include "ksr/update_filter.hpp"
+
+#include <chrono>
+#include <optional>
+#include <tuple>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    constexpr auto item_count = 1000000L;
+
+    // The policy that the combinator replaces: the percentage threshold is compared first, and the
+    // clock only read (and the interval only restarted) once it has been crossed.
+
+    template <typename count_t, typename total_t>
+    class hand_written_policy {
+    protected:
+
+        explicit hand_written_policy(const std::chrono::milliseconds interval)
+          : m_interval{interval} {}
+
+        auto can_update(
+            const std::tuple<count_t, total_t>& old_values,
+            const std::tuple<const count_t&, const total_t&>& new_values) const -> bool {
+
+            const auto& [new_count, new_total] = new_values;
+            if (std::get<1>(old_values) != 0 && new_total == m_threshold_total && new_count < m_next_count) {
+                return false;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now < m_next_update_time) {
+                return false;
+            }
+
+            m_next_update_time = now + m_interval;
+            return true;
+        }
+
+        void on_update(const std::tuple<count_t, total_t>& values) {
+            const auto& [count, total] = values;
+            if (const auto next = detail::next_fraction_count<100>(count, total)) {
+                m_next_count = *next;
+                m_threshold_total = total;
+            }
+        }
+
+    private:
+
+        std::chrono::steady_clock::duration m_interval;
+        mutable std::chrono::steady_clock::time_point m_next_update_time = std::chrono::steady_clock::time_point::min();
+        count_t m_next_count = count_t{};
+        total_t m_threshold_total = total_t{};
+    };
+
+    template <typename filter_t>
+    void run_scan(filter_t& filter) {
+        for (auto i = 0L; i < item_count; ++i) {
+            filter.update(i, item_count);
+        }
+    }
+}
+
+KSR_BENCHMARK(policy_combinators_all_of) {
+
+    using percent_and_20ms = filter_policy::all_of<filter_policy::sampled, filter_policy::int_percentage>;
+
+    auto updates = 0L;
+    const auto callback = [&](long, long) { ++updates; };
+
+    ctx.measure("hand-written percentage + 20ms policy", 20, [&] {
+        auto filter = basic_update_filter{update_filter_tag<hand_written_policy, long, long>{}, 20ms, callback};
+        run_scan(filter);
+    }, item_count);
+
+    ctx.measure("all_of<sampled, int_percentage>", 20, [&] {
+        auto filter = basic_update_filter{update_filter_tag<percent_and_20ms::policy, long, long>{}, 20ms, callback};
+        run_scan(filter);
+    }, item_count);
+
+    // For reference, the constituents alone.
+
+    ctx.measure("int_percentage", 20, [&] {
+        auto filter = basic_update_filter{update_filter_tag<filter_policy::int_percentage, long, long>{}, callback};
+        run_scan(filter);
+    }, item_count);
+
+    ctx.measure("sampled", 20, [&] {
+        auto filter = basic_update_filter{update_filter_tag<filter_policy::sampled, long, long>{}, 20ms, callback};
+        run_scan(filter);
+    }, item_count);
+
+    bench::do_not_optimise(updates);
+}
@@ -0,0 +1,79 @@
+#include "bench.hpp"
+
+#include "ksr/polled_filter.hpp"
+#include "ksr/update_filter.hpp"
+
+#include <chrono>
+#include <cstddef>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    constexpr auto item_count = 1000000L;
+
+    // Stands in for the per-item work of a worker loop, cheap enough that the cost of reporting
+    // progress dominates the differences between variants.
+
+    template <typename report_fn_t>
+    void run_worker(report_fn_t report_fn) {
+
+        auto checksum = 0L;
+        for (auto i = 0L; i < item_count; ++i) {
+            checksum += i ^ (checksum >> 3);
+            report_fn(i);
+        }
+
+        bench::do_not_optimise(checksum);
+    }
+}
+
+KSR_BENCHMARK(polled_filter_worker_loop) {
+
+    auto updates = 0L;
+    const auto items = static_cast<std::size_t>(item_count);
+
+    ctx.measure("no reporting", 20, [&] {
+        run_worker([](long) {});
+    }, items);
+
+    ctx.measure("int_percentage_filter::update", 20, [&] {
+        auto filter = int_percentage_filter<long>{[&](long, long) { ++updates; }};
+        run_worker([&](const long count) { filter.update(count + 1, item_count); });
+    }, items);
+
+    ctx.measure("sampled_filter::update (20ms)", 20, [&] {
+        auto filter = sampled_filter<long>{20ms, [&](long) { ++updates; }};
+        run_worker([&](const long count) { filter.update(count + 1); });
+    }, items);
+
+    // With polling, the policy runs on the sampler thread; the worker only writes a slot.
+
+    auto sampler = poll_sampler{10ms};
+
+    ctx.measure("polled int_percentage store", 20, [&] {
+        auto filter = polled_filter<filter_policy::int_percentage, long, long>{[&](long, long) { ++updates; }};
+        filter.store<1>(item_count);
+        const auto id = sampler.attach(filter);
+        run_worker([&](const long count) { filter.store<0>(count + 1); });
+        sampler.detach(id);
+    }, items);
+
+    ctx.measure("polled int_percentage add", 20, [&] {
+        auto filter = polled_filter<filter_policy::int_percentage, long, long>{[&](long, long) { ++updates; }};
+        filter.store<1>(item_count);
+        const auto id = sampler.attach(filter);
+        run_worker([&](long) { filter.add<0>(1); });
+        sampler.detach(id);
+    }, items);
+
+    ctx.measure("polled sampled store (20ms)", 20, [&] {
+        auto filter = polled_filter<filter_policy::sampled, long>{20ms, [&](long) { ++updates; }};
+        const auto id = sampler.attach(filter);
+        run_worker([&](const long count) { filter.store<0>(count + 1); });
+        sampler.detach(id);
+    }, items);
+
+    bench::do_not_optimise(updates);
+}
@@ -0,0 +1,217 @@
+#include "bench.hpp"
+
+#include "ksr/clock.hpp"
+#include "ksr/update_filter.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace ksr;
+
+namespace {
+
+    constexpr auto item_count = 1000;
+
+    // The callback captures enough state that libstdc++'s std::function can't store it locally,
+    // which is typical of progress callbacks that forward to some UI object.
+
+    struct sink {
+        long updates = 0;
+        long last_count = 0;
+        long last_total = 0;
+    };
+
+    template <typename filter_t>
+    void run_scan(filter_t& filter) {
+        for (auto i = 0L; i < item_count; ++i) {
+            filter.update(i, long{item_count});
+        }
+    }
+
+    template <typename make_filter_t>
+    void measure_variant(bench::context& ctx, const char* const label, make_filter_t make_filter) {
+
+        auto s = sink{};
+
+        ctx.measure(std::string{label} + " construct", 100000, [&] {
+            auto filter = make_filter(s);
+            bench::do_not_optimise(filter);
+        });
+
+        ctx.measure(std::string{label} + " construct + scan", 1000, [&] {
+            auto filter = make_filter(s);
+            run_scan(filter);
+        });
+
+        auto filter = make_filter(s);
+        ctx.measure(std::string{label} + " update", 1000000, [&] {
+            filter.update(s.last_count, long{item_count});
+        });
+
+        bench::do_not_optimise(s);
+    }
+}
+
+KSR_BENCHMARK(update_filter_callback_storage) {
+
+    measure_variant(ctx, "std::function", [](sink& s) {
+        return int_percentage_filter<long>{[&s, &updates = s.updates, &total = s.last_total](
+            const long count, const long new_total) {
+            ++updates;
+            s.last_count = count;
+            total = new_total;
+        }};
+    });
+
+    measure_variant(ctx, "deduced", [](sink& s) {
+        return basic_update_filter{
+            update_filter_tag<filter_policy::int_percentage, long, long>{},
+            [&s, &updates = s.updates, &total = s.last_total](
+                const long count, const long new_total) {
+                ++updates;
+                s.last_count = count;
+                total = new_total;
+            }};
+    });
+
+    measure_variant(ctx, "inplace_function", [](sink& s) {
+        return inplace_update_filter<filter_policy::int_percentage, long, long>{
+            [&s, &updates = s.updates, &total = s.last_total](
+                const long count, const long new_total) {
+                ++updates;
+                s.last_count = count;
+                total = new_total;
+            }};
+    });
+}
+
+namespace {
+
+    template <typename filter_t>
+    void measure_resolution(bench::context& ctx, const char* const label) {
+
+        auto updates = 0L;
+        auto filter = filter_t{[&updates](auto, auto) { ++updates; }};
+
+        using num_t = std::decay_t<decltype(filter.total())>;
+        static constexpr auto total = num_t{1000000};
+
+        auto count = num_t{};
+        ctx.measure(label, 1000000, [&] {
+            filter.update(count, total);
+            count += num_t{1};
+        });
+
+        bench::do_not_optimise(updates);
+    }
+}
+
+namespace {
+
+    // As for a scan that discovers more work as it goes: the total grows every few updates, so
+    // the threshold cached for one total is only of use until the next change.
+
+    template <typename filter_t>
+    void measure_growing_total(bench::context& ctx, const char* const label, const long growth_period) {
+
+        auto updates = 0L;
+        auto filter = filter_t{[&updates](auto, auto) { ++updates; }};
+
+        auto count = 0L;
+        ctx.measure(label, 1000000, [&] {
+            filter.update(count, 1000000 + count / growth_period);
+            ++count;
+        });
+
+        bench::do_not_optimise(updates);
+    }
+}
+
+KSR_BENCHMARK(update_filter_int_fraction) {
+    measure_resolution<int_percentage_filter<long>>(ctx, "percent (long)");
+    measure_resolution<int_per_mille_filter<long>>(ctx, "per-mille (long)");
+    measure_resolution<int_basis_points_filter<long>>(ctx, "basis points (long)");
+    measure_resolution<int_percentage_filter<double>>(ctx, "percent (double)");
+    measure_growing_total<int_percentage_filter<long>>(ctx, "percent (long), total growing every 64", 64);
+    measure_growing_total<int_percentage_filter<long>>(ctx, "percent (long), total growing every update", 1);
+}
+
+namespace {
+
+    template <typename chrono_clock_t>
+    void measure_clock(bench::context& ctx, const char* const label) {
+
+        auto updates = 0L;
+        auto filter = basic_sampled_filter<chrono_clock_t, long>{
+            std::chrono::milliseconds{20}, [&updates](long) { ++updates; }};
+
+        auto value = 0L;
+        ctx.measure(label, 1000000, [&] {
+            filter.update(++value);
+        });
+
+        bench::do_not_optimise(updates);
+    }
+}
+
+KSR_BENCHMARK(update_filter_sampled_clock) {
+
+    measure_clock<std::chrono::steady_clock>(ctx, "steady_clock");
+    measure_clock<coarse_steady_clock>(ctx, "coarse_steady_clock");
+#ifdef KSR_HAS_TSC_CLOCK
+    tsc_clock::calibrate();
+    measure_clock<tsc_clock>(ctx, "tsc_clock");
+#endif
+    measure_clock<every_nth_clock<std::chrono::steady_clock, 64>>(ctx, "every_nth_clock<steady_clock, 64>");
+}
+
+KSR_BENCHMARK(update_filter_payload_copies) {
+
+    // Long enough to defeat the small-string optimisation, so that each copy allocates.
+
+    const auto path = std::string(64, 'x');
+    const auto tags = std::vector<int>(16, 1);
+    auto updates = 0L;
+
+    auto filter = sampled_filter<std::string, std::vector<int>>{std::chrono::hours{1},
+        [&updates](const std::string&, const std::vector<int>&) { ++updates; }};
+
+    filter.update(path, tags);
+    ctx.measure("sampled_filter<string, vector<int>> rejected", 1000000, [&] {
+        filter.update(path, tags);
+    });
+
+    bench::do_not_optimise(updates);
+}
+
+namespace {
+
+    template <typename... value_ts>
+    void measure_delta(bench::context& ctx, const char* const label) {
+
+        auto updates = 0L;
+        auto filter = delta_filter<value_ts...>{delta_threshold{0.5, 0.01},
+            [&updates](value_ts...) { ++updates; }};
+
+        // Jitter within the tolerance, so that (after the first) every update is rejected, and
+        // the cost measured is that of the comparison.
+
+        auto step = 0;
+        ctx.measure(label, 1000000, [&] {
+            const auto jitter = static_cast<float>(step++ & 3) * 0.1f;
+            filter.update(static_cast<value_ts>(jitter)...);
+        });
+
+        bench::do_not_optimise(updates);
+    }
+}
+
+KSR_BENCHMARK(update_filter_delta) {
+    measure_delta<float, float, float>(ctx, "delta (3 x float)");
+    measure_delta<float, float, float, float, float, float, float, float>(ctx, "delta (8 x float)");
+    measure_delta<double, double, double, double>(ctx, "delta (4 x double)");
+    measure_delta<double, float, int>(ctx, "delta (double, float, int)");
+}
@@ -0,0 +1,20 @@
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+// Runs every registered benchmark whose name contains the first command-line argument (or all of
+// them, if no argument is given).
+
+int main(const int argc, const char* const argv[]) {
+
+    const auto filter = argc > 1 ? argv[1] : "";
+
+    auto ctx = ksr::bench::context{};
+    for (const auto& [name, fn] : ksr::bench::registry()) {
+        if (std::strstr(name, filter)) {
+            std::printf("%s\n", name);
+            fn(ctx);
+        }
+    }
+}
@@ -2,44 +2,796 @@
 #define KSR_ALGORITHM_HPP
 
 #include "range.hpp"
+#include "simd_find.hpp"
 #include "type_util.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <optional>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace ksr {
 
+    namespace detail {
+
+        template <typename range_t, typename t>
+        constexpr auto has_member_contains(int)
+            -> decltype(bool(std::declval<const range_t&>().contains(std::declval<const t&>()))) { return true; }
+
+        template <typename range_t, typename t>
+        constexpr auto has_member_contains(...) -> bool { return false; }
+
+        // Requiring the result of find() to be comparable with end() excludes the find() members
+        // of std::string and the like, which return an index rather than an iterator.
+
+        template <typename range_t, typename t>
+        constexpr auto has_member_find(int) -> decltype(
+            bool(std::declval<const range_t&>().find(std::declval<const t&>()) != std::declval<const range_t&>().end())) {
+            return true;
+        }
+
+        template <typename range_t, typename t>
+        constexpr auto has_member_find(...) -> bool { return false; }
+
+        template <typename range_t>
+        constexpr auto has_data(int) -> decltype(
+            std::data(std::declval<const range_t&>()), std::size(std::declval<const range_t&>()), bool{}) {
+            return std::is_pointer_v<decltype(std::data(std::declval<const range_t&>()))>;
+        }
+
+        template <typename range_t>
+        constexpr auto has_data(...) -> bool { return false; }
+
+        // Searching for a value of another integral type is equivalent to searching for its
+        // conversion to the element type, provided that the conversion is exact (as otherwise no
+        // element could compare equal to it).
+
+        template <typename elem_t, typename t>
+        inline constexpr auto is_bitwise_search_v = is_bitwise_searchable_v<elem_t> && (std::is_same_v<elem_t, t> ||
+            (std::is_integral_v<elem_t> && std::is_integral_v<t> && !std::is_same_v<t, bool>));
+
+        // Whether the arithmetic value converts to elem_t without loss, in which case comparing
+        // the conversion with an elem_t is equivalent to comparing value with it. (A floating-point
+        // value outside the range of elem_t is checked first, as its conversion is undefined.)
+
+        template <typename elem_t, typename t>
+        auto converts_exactly(const t& value) -> bool {
+
+            if constexpr (std::is_same_v<elem_t, t>) {
+                return true;
+            } else {
+
+                if constexpr (std::is_floating_point_v<t> && std::is_integral_v<elem_t>) {
+                    const auto limit = std::ldexp(t{1}, std::numeric_limits<elem_t>::digits);
+                    if (!(value < limit && value >= (std::is_signed_v<elem_t> ? -limit : t{0}))) {
+                        return false;
+                    }
+                } else if constexpr (std::is_floating_point_v<t> && std::is_floating_point_v<elem_t>) {
+                    if (std::isfinite(value) && std::abs(value) > std::numeric_limits<elem_t>::max()) {
+                        return false;
+                    }
+                }
+
+                const auto converted = static_cast<elem_t>(value);
+                using common_t = decltype(converted + value);
+                return static_cast<common_t>(converted) == static_cast<common_t>(value);
+            }
+        }
+
+        // The keys looked up by a member contains() or find() of a range: its key_type where it
+        // has one, and otherwise its elements.
+
+        template <typename range_t, typename = void>
+        struct lookup_key {
+            using type = std::remove_cv_t<std::remove_reference_t<decltype(*adl_begin(std::declval<const range_t&>()))>>;
+        };
+
+        template <typename range_t>
+        struct lookup_key<range_t, std::void_t<typename range_t::key_type>> {
+            using type = typename range_t::key_type;
+        };
+
+        // A member lookup converts an arithmetic value of another type to the key type, so is
+        // only equivalent to comparing the value with each key if that conversion is exact (no
+        // int key compares equal to 1.5, although 1.5 would be looked up as 1).
+
+        template <typename range_t, typename t>
+        auto contains_via_member(const range_t& range, const t& value) -> bool {
+
+            using key_t = typename lookup_key<range_t>::type;
+            if constexpr (std::is_arithmetic_v<key_t> && std::is_arithmetic_v<t>) {
+                if (!converts_exactly<key_t>(value)) {
+                    return false;
+                }
+            }
+
+            if constexpr (has_member_contains<range_t, t>(int{})) {
+                return bool(range.contains(value));
+            } else {
+                return range.find(value) != range.end();
+            }
+        }
+
+        template <typename elem_t, typename t>
+        auto contains_bitwise(const elem_t* const begin, const elem_t* const end, const t& value) -> bool {
+
+            if (!converts_exactly<elem_t>(value)) {
+                return false;
+            }
+
+            return find_bitwise(begin, end, static_cast<elem_t>(value)) != end;
+        }
+    }
+
+    /// Determines whether any element of the range `[begin, end)` compares equal to `value`, as if
+    /// by `std::find()`. Where the iterators are pointers to integers or enumerators, the search
+    /// compares many elements at once (see `detail::find_bitwise()`).
+
     template <typename input_it, typename t>
     auto contains(const input_it begin, const input_it end, const t& value) -> bool {
-        return std::find(begin, end, value) != end;
+
+        if constexpr (std::is_pointer_v<input_it>) {
+            using elem_t = std::remove_cv_t<std::remove_pointer_t<input_it>>;
+            if constexpr (detail::is_bitwise_search_v<elem_t, t>) {
+                return detail::contains_bitwise<elem_t>(begin, end, value);
+            } else {
+                return std::find(begin, end, value) != end;
+            }
+        } else {
+            return std::find(begin, end, value) != end;
+        }
     }
 
+    /// Determines whether `range` contains `value`. Where `range` provides a member function
+    /// `contains()` or `find()` that accepts `value` (as do the associative containers, including
+    /// through heterogeneous lookup where their comparators allow it, and typical sorted flat
+    /// containers), that member is used, in logarithmic or constant time; otherwise, the range is
+    /// searched linearly, as a contiguous array where `std::data()` permits. (For maps, `value`
+    /// is therefore a key.) An arithmetic `value` that no key could compare equal to, because its
+    /// conversion to the key type is inexact, is never found.
+
     template <typename range_t, typename t, typename = std::enable_if_t<is_range_v<range_t>>>
     auto contains(const range_t& range, const t& value) -> bool {
-        return contains(adl_begin(range), adl_end(range), value);
+
+        if constexpr (detail::has_member_contains<range_t, t>(int{}) || detail::has_member_find<range_t, t>(int{})) {
+            return detail::contains_via_member(range, value);
+        } else if constexpr (detail::has_data<range_t>(int{})) {
+            const auto data = std::data(range);
+            return contains(data, data + std::size(range), value);
+        } else {
+            return contains(adl_begin(range), adl_end(range), value);
+        }
+    }
+
+    /// Determines whether the range `[begin, end)`, which must be sorted with respect to `comp`,
+    /// contains an element equivalent to `value`, in logarithmic time (for random-access
+    /// iterators) as if by `std::binary_search()`.
+
+    template <typename forward_it, typename t, typename comp_t = std::less<>>
+    auto contains_sorted(const forward_it begin, const forward_it end, const t& value, comp_t comp = {}) -> bool {
+        return std::binary_search(begin, end, value, comp);
+    }
+
+    template <
+        typename range_t, typename t, typename comp_t = std::less<>,
+        typename = std::enable_if_t<is_range_v<range_t>>
+    >
+    auto contains_sorted(const range_t& range, const t& value, comp_t comp = {}) -> bool {
+        return contains_sorted(adl_begin(range), adl_end(range), value, comp);
+    }
+
+    namespace detail {
+
+        template <typename t>
+        constexpr auto is_hashable(int) -> decltype(std::hash<t>{}(std::declval<const t&>()), bool{}) { return true; }
+
+        template <typename t>
+        constexpr auto is_hashable(...) -> bool { return false; }
+
+        template <typename t>
+        constexpr auto is_less_comparable(int)
+            -> decltype(bool(std::declval<const t&>() < std::declval<const t&>())) { return true; }
+
+        template <typename t>
+        constexpr auto is_less_comparable(...) -> bool { return false; }
+
+        template <typename range_t, typename t>
+        constexpr auto is_contiguous_bitwise_search() -> bool {
+
+            if constexpr (has_data<range_t>(int{})) {
+                using elem_t = std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<const range_t&>()))>>;
+                return is_bitwise_search_v<elem_t, t>;
+            } else {
+                return false;
+            }
+        }
+
+        template <typename range_t, typename category_t>
+        inline constexpr auto has_iterator_category_v = std::is_base_of_v<category_t,
+            typename std::iterator_traits<std::decay_t<decltype(adl_begin(std::declval<const range_t&>()))>>::iterator_category>;
+
+        // Needle sets up to this size are searched for one at a time in contiguous haystacks of
+        // integers: each scan compares a vector's worth of elements per instruction, so is
+        // cheaper than a hash probe per element until there are a few dozen needles. Haystacks
+        // up to the second size are also searched for each needle in turn.
+
+        inline constexpr auto batch_scan_needle_limit = std::size_t{32};
+        inline constexpr auto batch_scan_haystack_limit = std::size_t{8};
+
+        /// How soon a batch query may stop: only once every needle has been found, or also once
+        /// any has been found, or once any is known to be missing.
+
+        enum class batch_stop { at_all_found, at_any_found, at_any_missing };
+
+        /// The distinct keys that the needles of a batch query may match, each with a flag
+        /// recording whether it has been found, and the index of each needle's key (so that
+        /// duplicate needles share one). A needle that no element could compare equal to has no
+        /// key, which is represented by the number of needles.
+
+        struct batch_entries {
+
+            /// Records that the key `entry` has been found, returning whether the query may stop.
+
+            auto mark(const std::size_t entry, const batch_stop stop) -> bool {
+                if (!found[entry]) {
+                    found[entry] = true;
+                    ++found_count;
+                }
+                return stop == batch_stop::at_any_found || found_count == found.size();
+            }
+
+            auto any_missing() const -> bool {
+                return std::find(entry_of_needle.begin(), entry_of_needle.end(), entry_of_needle.size()) !=
+                    entry_of_needle.end();
+            }
+
+            auto result() const -> std::vector<bool> {
+                const auto needle_count = entry_of_needle.size();
+                auto flags = std::vector<bool>(needle_count);
+                for (auto i = std::size_t{0}; i < needle_count; ++i) {
+                    const auto entry = entry_of_needle[i];
+                    flags[i] = entry != needle_count && found[entry];
+                }
+                return flags;
+            }
+
+            std::vector<std::size_t> entry_of_needle;
+            std::vector<bool> found;
+            std::size_t found_count = 0;
+        };
+
+        /// Looks up each element of `haystack` in a hash table of the keys of `needles`, in one
+        /// pass.
+
+        template <typename elem_t, typename haystack_t, typename needles_t>
+        auto batch_contains_hashed(const haystack_t& haystack, const needles_t& needles, const std::size_t needle_count,
+            const batch_stop stop) -> std::vector<bool> {
+
+            auto keys = std::unordered_map<elem_t, std::size_t>{};
+            auto entries = batch_entries{};
+            for (const auto& needle : needles) {
+                entries.entry_of_needle.push_back(converts_exactly<elem_t>(needle)
+                    ? keys.emplace(static_cast<elem_t>(needle), keys.size()).first->second
+                    : needle_count);
+            }
+
+            if (keys.empty() || (stop == batch_stop::at_any_missing && entries.any_missing())) {
+                return std::vector<bool>(needle_count);
+            }
+
+            entries.found.assign(keys.size(), false);
+            for (const auto& elem : haystack) {
+                const auto iter = keys.find(elem);
+                if (iter != keys.end() && entries.mark(iter->second, stop)) {
+                    break;
+                }
+            }
+
+            return entries.result();
+        }
+
+        /// Merges `haystack` with the sorted keys of `needles`, in one pass. An element that
+        /// doesn't ascend past the keys already passed (as in an unsorted haystack) is instead
+        /// looked up among those keys, by hash where `use_hash`, and otherwise by binary search,
+        /// so the haystack needn't be sorted, but is searched fastest if it is. A sorted prefix
+        /// of a random-access haystack is binary searched for each key instead, where that takes
+        /// fewer comparisons than merging it.
+
+        template <typename elem_t, bool use_hash, typename haystack_t, typename needles_t>
+        auto batch_contains_sorted(const haystack_t& haystack, const needles_t& needles, const std::size_t needle_count,
+            const batch_stop stop) -> std::vector<bool> {
+
+            auto keys = std::vector<elem_t>{};
+            for (const auto& needle : needles) {
+                if (converts_exactly<elem_t>(needle)) {
+                    keys.push_back(static_cast<elem_t>(needle));
+                }
+            }
+
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end(),
+                [](const auto& lhs, const auto& rhs) { return !(lhs < rhs) && !(rhs < lhs); }), keys.end());
+
+            auto entries = batch_entries{};
+            for (const auto& needle : needles) {
+                entries.entry_of_needle.push_back(converts_exactly<elem_t>(needle)
+                    ? static_cast<std::size_t>(
+                          std::lower_bound(keys.begin(), keys.end(), static_cast<elem_t>(needle)) - keys.begin())
+                    : needle_count);
+            }
+
+            if (keys.empty() || (stop == batch_stop::at_any_missing && entries.any_missing())) {
+                return std::vector<bool>(needle_count);
+            }
+
+            entries.found.assign(keys.size(), false);
+
+            auto first = adl_begin(haystack);
+            const auto last = adl_end(haystack);
+
+            if constexpr (has_iterator_category_v<haystack_t, std::random_access_iterator_tag>) {
+
+                const auto sorted_last = std::is_sorted_until(first, last);
+                const auto sorted_count = static_cast<std::size_t>(sorted_last - first);
+
+                auto depth = std::size_t{1};
+                for (auto count = sorted_count; count > 1; count /= 2) {
+                    ++depth;
+                }
+
+                if (keys.size() * depth < sorted_count) {
+                    for (auto entry = std::size_t{0}; entry < keys.size(); ++entry) {
+                        if (std::binary_search(first, sorted_last, keys[entry]) && entries.mark(entry, stop)) {
+                            return entries.result();
+                        }
+                    }
+                    first = sorted_last;
+                }
+            }
+
+            // Every key before passed is less than some element already merged.
+
+            auto passed = std::size_t{0};
+            auto hashed = std::conditional_t<use_hash, std::unordered_map<elem_t, std::size_t>, std::tuple<>>{};
+
+            const auto find_passed = [&](const elem_t& elem) {
+                if constexpr (use_hash) {
+                    if (hashed.empty()) {
+                        for (auto entry = std::size_t{0}; entry < keys.size(); ++entry) {
+                            hashed.emplace(keys[entry], entry);
+                        }
+                    }
+                    const auto iter = hashed.find(elem);
+                    return iter != hashed.end() ? iter->second : needle_count;
+                } else {
+                    const auto passed_end = keys.begin() + static_cast<std::ptrdiff_t>(passed);
+                    const auto iter = std::lower_bound(keys.begin(), passed_end, elem);
+                    return iter != passed_end && !(elem < *iter)
+                        ? static_cast<std::size_t>(iter - keys.begin()) : needle_count;
+                }
+            };
+
+            for (; first != last; ++first) {
+
+                const auto& elem = *first;
+                auto entry = needle_count;
+
+                if (passed == 0 || keys[passed - 1] < elem) {
+                    while (passed < keys.size() && keys[passed] < elem) {
+                        ++passed;
+                    }
+                    if (passed < keys.size() && !(elem < keys[passed])) {
+                        entry = passed;
+                    }
+                } else {
+                    entry = find_passed(elem);
+                }
+
+                if (entry != needle_count && entries.mark(entry, stop)) {
+                    break;
+                }
+            }
+
+            return entries.result();
+        }
+
+        /// Determines which of `needles` occur in `haystack`, stopping early as `stop` allows (in
+        /// which case the needles not yet searched for are reported missing). The strategy
+        /// depends on the types, the number of needles and the iterator category of the haystack:
+        /// - lookup via `contains()` for haystacks with a member `contains()` or `find()`;
+        /// - one scan per needle for a few needles in a contiguous haystack of integers (which
+        ///   `contains()` makes a vectorised scan), or any needles in a tiny random-access
+        ///   haystack;
+        /// - where the needles are of the element type or, for integers, convert exactly to it,
+        ///   a single pass over the haystack, merging it with the sorted needles for types that
+        ///   can be ordered (see `batch_contains_sorted()`), or else probing a hash table of
+        ///   them;
+        /// - failing those, one pass over the haystack per needle, or for haystacks that can
+        ///   only be traversed once, one pass comparing each element with every needle.
+        ///
+        /// The needles are traversed in place unless they can only be traversed once, in which
+        /// case they are copied first.
+
+        template <typename haystack_t, typename needles_t>
+        auto batch_contains(const haystack_t& haystack, const needles_t& needles, const batch_stop stop)
+            -> std::vector<bool> {
+
+            using needle_t = std::decay_t<decltype(*adl_begin(needles))>;
+            using elem_t = std::decay_t<decltype(*adl_begin(haystack))>;
+
+            if constexpr (!has_iterator_category_v<needles_t, std::forward_iterator_tag>) {
+
+                auto copies = std::vector<needle_t>{};
+                for (const auto& needle : needles) {
+                    copies.push_back(needle);
+                }
+
+                return batch_contains(haystack, copies, stop);
+            } else {
+
+                const auto needle_count = static_cast<std::size_t>(std::distance(adl_begin(needles), adl_end(needles)));
+                if (needle_count == 0) {
+                    return {};
+                }
+
+                const auto scan_each = [&] {
+                    auto result = std::vector<bool>(needle_count);
+                    auto i = std::size_t{0};
+                    for (const auto& needle : needles) {
+                        result[i] = contains(haystack, needle);
+                        if (stop == (result[i] ? batch_stop::at_any_found : batch_stop::at_any_missing)) {
+                            break;
+                        }
+                        ++i;
+                    }
+                    return result;
+                };
+
+                const auto scan_once = [&] {
+                    auto result = std::vector<bool>(needle_count);
+                    auto found_count = std::size_t{0};
+                    for (const auto& elem : haystack) {
+                        auto i = std::size_t{0};
+                        for (const auto& needle : needles) {
+                            if (!result[i] && elem == needle) {
+                                result[i] = true;
+                                if (stop == batch_stop::at_any_found || ++found_count == needle_count) {
+                                    return result;
+                                }
+                            }
+                            ++i;
+                        }
+                    }
+                    return result;
+                };
+
+                if constexpr (has_member_contains<haystack_t, needle_t>(int{}) || has_member_find<haystack_t, needle_t>(int{})) {
+                    return scan_each();
+                } else {
+
+                    if constexpr (is_contiguous_bitwise_search<haystack_t, needle_t>()) {
+                        if (needle_count <= batch_scan_needle_limit) {
+                            return scan_each();
+                        }
+                    }
+
+                    if constexpr (has_iterator_category_v<haystack_t, std::random_access_iterator_tag>) {
+                        if (static_cast<std::size_t>(std::distance(adl_begin(haystack), adl_end(haystack))) <=
+                            batch_scan_haystack_limit) {
+                            return scan_each();
+                        }
+                    }
+
+                    // Integer needles of another type are keyed by their conversion to the
+                    // element type (which, as in contains_bitwise(), only an exact conversion can
+                    // match), so that the elements can be looked up as they are.
+
+                    constexpr auto keyed_by_elem = std::is_same_v<elem_t, needle_t> || (
+                        std::is_integral_v<elem_t> && std::is_integral_v<needle_t> &&
+                        !std::is_same_v<elem_t, bool> && !std::is_same_v<needle_t, bool>);
+                    constexpr auto use_hash = keyed_by_elem && is_hashable<elem_t>(int{});
+                    constexpr auto use_sort = keyed_by_elem && is_less_comparable<elem_t>(int{});
+
+                    if constexpr (use_sort) {
+                        return batch_contains_sorted<elem_t, use_hash>(haystack, needles, needle_count, stop);
+                    } else if constexpr (use_hash) {
+                        return batch_contains_hashed<elem_t>(haystack, needles, needle_count, stop);
+                    } else if constexpr (has_iterator_category_v<haystack_t, std::forward_iterator_tag>) {
+                        return scan_each();
+                    } else {
+                        return scan_once();
+                    }
+                }
+            }
+        }
+    }
+
+    /// Determines which elements of the range `needles` are contained in the range `haystack`, as
+    /// per `contains()`, returning a bitmap with one flag per needle. Rather than searching the
+    /// haystack once per needle, a strategy is chosen to suit the types, sizes and iterator
+    /// categories involved (see `detail::batch_contains()`); for hashable or ordered elements,
+    /// the haystack is traversed once, fastest if it is sorted. Either range may be an input
+    /// range.
+
+    template <
+        typename haystack_t, typename needles_t,
+        typename = std::enable_if_t<is_range_v<haystack_t> && is_range_v<needles_t>>
+    >
+    auto contains_each(const haystack_t& haystack, const needles_t& needles) -> std::vector<bool> {
+        return detail::batch_contains(haystack, needles, detail::batch_stop::at_all_found);
+    }
+
+    /// Counts the elements of the range `needles` that are contained in the range `haystack`, as
+    /// per `contains_each()`.
+
+    template <
+        typename haystack_t, typename needles_t,
+        typename = std::enable_if_t<is_range_v<haystack_t> && is_range_v<needles_t>>
+    >
+    auto count_contained(const haystack_t& haystack, const needles_t& needles) -> std::size_t {
+        const auto found = detail::batch_contains(haystack, needles, detail::batch_stop::at_all_found);
+        return static_cast<std::size_t>(std::count(found.begin(), found.end(), true));
+    }
+
+    /// Determines whether any element of the range `needles` is contained in the range
+    /// `haystack`, as per `contains_each()`, but stopping as soon as one is found.
+
+    template <
+        typename haystack_t, typename needles_t,
+        typename = std::enable_if_t<is_range_v<haystack_t> && is_range_v<needles_t>>
+    >
+    auto contains_any(const haystack_t& haystack, const needles_t& needles) -> bool {
+        const auto found = detail::batch_contains(haystack, needles, detail::batch_stop::at_any_found);
+        return std::find(found.begin(), found.end(), true) != found.end();
+    }
+
+    /// Determines whether every element of the range `needles` is contained in the range
+    /// `haystack`, as per `contains_each()`, but stopping as soon as all have been found, or as
+    /// soon as one is known to be missing.
+
+    template <
+        typename haystack_t, typename needles_t,
+        typename = std::enable_if_t<is_range_v<haystack_t> && is_range_v<needles_t>>
+    >
+    auto contains_all(const haystack_t& haystack, const needles_t& needles) -> bool {
+        const auto found = detail::batch_contains(haystack, needles, detail::batch_stop::at_any_missing);
+        return std::find(found.begin(), found.end(), false) == found.end();
+    }
+
+    namespace detail {
+
+        template <typename container_t, typename pred_t>
+        constexpr auto has_member_remove_if(int)
+            -> decltype(std::declval<container_t&>().remove_if(std::declval<pred_t>()), bool{}) { return true; }
+
+        template <typename container_t, typename pred_t>
+        constexpr auto has_member_remove_if(...) -> bool { return false; }
+
+        template <typename container_t>
+        constexpr auto has_range_erase(int) -> decltype(
+            std::declval<container_t&>().erase(adl_begin(std::declval<container_t&>()), adl_end(std::declval<container_t&>())),
+            bool{}) {
+            using iter_t = decltype(adl_begin(std::declval<container_t&>()));
+            return std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iter_t>::iterator_category>;
+        }
+
+        template <typename container_t>
+        constexpr auto has_range_erase(...) -> bool { return false; }
     }
 
-    /// Iterates through all elements in `container` and calls Container::erase() individually for
-    /// each one that satisfies `pred` (when invoked as per `std::invoke()`. `container_t` should be
-    /// an STL-style container type for which repeated single-element erasure is preferable to the
-    /// standard erase-remove idiom (or for which the latter approach is not possible, e.g. the
-    /// associative containers). `pred` should be a function object for which
-    /// `std::invoke(pred, item)` is well-formed and convertible to `bool` when `item` as an object
-    /// of type `container_t::value_type`.
+    /// Erases every element of `container` that satisfies `pred` (when invoked as per
+    /// `std::invoke()`), preserving the order of the remaining elements, and returns the number
+    /// of elements erased. `pred` should be a function object for which `std::invoke(pred, item)`
+    /// is well-formed and convertible to `bool` when `item` is an object of type
+    /// `container_t::value_type`. The method of erasure depends on the container:
+    /// - for random-access sequences (such as `std::vector`, `std::deque` and `std::string`), the
+    ///   erase-remove idiom, in linear time;
+    /// - for containers with a member `remove_if()` (such as `std::list` and
+    ///   `std::forward_list`), that member, which relinks nodes rather than moving elements;
+    /// - otherwise (e.g. for the associative containers), `container_t::erase()` for each element
+    ///   individually.
 
     template <typename container_t, typename pred_t>
-    void erase_if(container_t &container, pred_t pred) {
+    auto erase_if(container_t& container, pred_t pred) -> std::size_t {
 
-        auto iter = adl_begin(container);
-        while (iter != adl_end(container)) {
+        auto erased = std::size_t{0};
+        const auto counting_pred = [&](auto& item) -> bool {
+            const auto result = bool(std::invoke(pred, item));
+            erased += result;
+            return result;
+        };
 
-            if (std::invoke(pred, *iter)) {
-                iter = container.erase(iter);
+        if constexpr (detail::has_range_erase<container_t>(int{})) {
+            const auto end = adl_end(container);
+            const auto new_end = std::remove_if(adl_begin(container), end, [&](auto& item) -> bool {
+                return bool(std::invoke(pred, item));
+            });
+            erased = narrow_cast<std::size_t>(std::distance(new_end, end));
+            container.erase(new_end, end);
+        } else if constexpr (detail::has_member_remove_if<container_t, decltype(counting_pred)>(int{})) {
+            container.remove_if(counting_pred);
+        } else {
+
+            auto iter = adl_begin(container);
+            while (iter != adl_end(container)) {
+
+                if (counting_pred(*iter)) {
+                    iter = container.erase(iter);
+                } else {
+                    ++iter;
+                }
+            }
+        }
+
+        return erased;
+    }
+
+    /// Erases every element of the random-access sequence `container` that satisfies `pred`, as
+    /// per `erase_if()`, but without preserving the order of the remaining elements: each erased
+    /// element is replaced by the last element, which is then popped. This moves one element per
+    /// erasure, rather than every element after the first erased, so is preferable when order
+    /// doesn't matter and few elements are erased. Returns the number of elements erased.
+
+    template <typename container_t, typename pred_t>
+    auto erase_if_unstable(container_t& container, pred_t pred) -> std::size_t {
+
+        static_assert(detail::has_range_erase<container_t>(int{}), "container must be a random-access sequence");
+
+        // Each element erased is overwritten by the last element not yet examined, which is then
+        // examined in its place; the moved-from tail is erased at the end.
+
+        const auto first = adl_begin(container);
+        auto size = std::distance(first, adl_end(container));
+        auto index = decltype(size){0};
+
+        while (index < size) {
+
+            if (std::invoke(pred, first[index])) {
+                --size;
+                if (index != size) {
+                    first[index] = std::move(first[size]);
+                }
             } else {
-                ++iter;
+                ++index;
+            }
+        }
+
+        const auto erased = narrow_cast<std::size_t>(std::distance(first + size, adl_end(container)));
+        container.erase(first + size, adl_end(container));
+
+        return erased;
+    }
+
+    /// The values by which a callback of `k_permute()` or `sub_permute()` may control the
+    /// enumeration: `proceed`, to carry on; `skip_extensions`, to skip the partial permutations
+    /// that extend the one just passed to the callback (which only has an effect where those
+    /// follow it, i.e. for `sub_permute_order::prefix_tree`; elsewhere, it is the same as
+    /// `proceed`); or `stop`, to return at once (with the range sorted once more). Callbacks
+    /// that return `void` always proceed.
+
+    enum class permute_control { proceed, skip_extensions, stop };
+
+    namespace detail {
+
+        template <typename callback_t, typename it>
+        inline constexpr auto is_permute_controlled_v = !std::is_void_v<std::invoke_result_t<callback_t&, it, it>>;
+
+        template <typename callback_t, typename it>
+        auto invoke_permute_callback(callback_t& callback, const it begin, const it end) -> permute_control {
+
+            if constexpr (!is_permute_controlled_v<callback_t, it>) {
+                std::invoke(callback, begin, end);
+                return permute_control::proceed;
+            } else {
+                static_assert(std::is_same_v<std::invoke_result_t<callback_t&, it, it>, permute_control>,
+                    "a permutation callback must return void or permute_control");
+                return std::invoke(callback, begin, end);
+            }
+        }
+
+        // Sorts [begin, end) given that [mid, end) is sorted, by inserting each element of
+        // [begin, mid) in turn, from the last; this is only done when enumeration stops early.
+
+        template <typename bidir_it>
+        void restore_sorted(const bidir_it begin, bidir_it mid, const bidir_it end) {
+
+            while (mid != begin) {
+                const auto item = std::prev(mid);
+                std::rotate(item, mid, std::lower_bound(mid, end, *item));
+                mid = item;
+            }
+        }
+
+        // Returns false if the callback stopped the enumeration.
+
+        template <typename bidir_it, typename callback_t>
+        auto k_permute(const bidir_it begin, const bidir_it end, const std::size_t k, callback_t& callback) -> bool {
+
+            // The unused elements, [mid, end), are kept sorted. Each partial permutation is
+            // followed by the one that replaces its last element with the next greater unused
+            // element, until there are none; the rightmost element that can then be increased is
+            // found as by std::next_permutation(), and the elements after it are sorted back into
+            // the unused elements, from which it takes its successor and they take their minimum.
+            // The unused elements are only moved when an element other than the last is increased,
+            // which happens once for every n - k + 1 partial permutations or fewer.
+
+            auto mid = begin;
+            std::advance(mid, k);
+
+            if (mid == begin) {
+                return invoke_permute_callback(callback, begin, mid) != permute_control::stop;
+            }
+
+            // With no unused elements, std::next_permutation() does no more work than is needed.
+
+            if (mid == end) {
+                do {
+                    if (invoke_permute_callback(callback, begin, mid) == permute_control::stop) {
+                        restore_sorted(begin, mid, end);
+                        return false;
+                    }
+                } while (std::next_permutation(begin, end));
+                return true;
+            }
+
+            const auto last = std::prev(mid);
+            for (;;) {
+
+                auto next = std::upper_bound(mid, end, *last);
+                for (;;) {
+
+                    if (invoke_permute_callback(callback, begin, mid) == permute_control::stop) {
+                        restore_sorted(begin, mid, end);
+                        return false;
+                    }
+
+                    if (next == end) {
+                        break;
+                    }
+
+                    // The element displaced into the unused elements is less than its successors,
+                    // so they remain sorted.
+
+                    std::iter_swap(last, next);
+                    do {
+                        ++next;
+                    } while (next != end && !(*last < *next));
+                }
+
+                // Every element after the pivot is now at its maximum: [pivot + 1, mid) is
+                // non-increasing, and not less than any unused element.
+
+                auto pivot = last;
+                auto found = false;
+                while (pivot != begin) {
+
+                    const auto successor = pivot--;
+                    if (*pivot < *successor) {
+                        found = true;
+                        break;
+                    }
+                }
+
+                // Reversing [after, mid) and then rotating it behind the unused elements sorts
+                // [after, end); so does reversing the unused elements and then the whole.
+
+                const auto after = found ? std::next(pivot) : begin;
+                std::reverse(mid, end);
+                std::reverse(after, end);
+
+                if (!found) {
+                    return true;
+                }
+
+                std::iter_swap(pivot, std::upper_bound(after, end, *pivot));
             }
         }
     }
@@ -47,20 +799,16 @@ namespace ksr {
     /// Invokes `callback` on each  `k`-element partial permutation of the sorted range
     /// `[begin, end)`, in lexicographic order. Elements of this range are permuted in-place; once
     /// this algorithm returns, the range is once more sorted as if by `std::sort()`. `callback`
-    /// must be a function object for which `std::invoke(callback, begin, end)` is well-formed.
-    /// `callback` may not assign to any element in the original range.
+    /// must be a function object for which `std::invoke(callback, begin, end)` is well-formed,
+    /// returning either `void` or a `permute_control` (with which it may stop the enumeration).
+    /// `callback` may not assign to any element in the original range. `k` may not exceed the
+    /// size of the range. Each partial permutation takes amortised constant time to generate
+    /// (for random-access iterators), however small `k` is relative to the size of the range.
 
     template <typename bidir_it, typename callback_t>
     void k_permute(
         const bidir_it begin, const bidir_it end, const std::size_t k, callback_t callback) {
-
-        auto mid = begin;
-        std::advance(mid, k);
-
-        do {
-            std::invoke(callback, begin, mid);
-            std::reverse(mid, end);
-        } while (std::next_permutation(begin, end));
+        detail::k_permute(begin, end, k, callback);
     }
 
     template <typename range_t, typename callback_t, typename = std::enable_if_t<is_range_v<range_t>>>
@@ -68,6 +816,174 @@ namespace ksr {
         k_permute(adl_begin(range), adl_end(range), k, callback);
     }
 
+    namespace detail {
+
+        // Sets value to value * radix + digit, unless that overflows (in which case this returns
+        // false); digit must be less than radix.
+
+        inline auto checked_mixed_radix_step(std::uint64_t& value, const std::size_t radix, const std::size_t digit)
+            -> bool {
+
+            constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+            if (radix != 0 && value > (max - digit) / radix) {
+                return false;
+            }
+
+            value = value * radix + digit;
+            return true;
+        }
+
+        template <typename forward_it>
+        auto is_strictly_increasing(const forward_it begin, const forward_it end) -> bool {
+            return std::adjacent_find(begin, end, [](const auto& lhs, const auto& rhs) { return !(lhs < rhs); }) == end;
+        }
+    }
+
+    /// Returns the number of `k`-element partial permutations of `n` distinct elements,
+    /// `n! / (n - k)!` (which is zero if `k` exceeds `n`), or an empty optional if this number
+    /// is not representable as a `std::uint64_t`.
+
+    inline auto k_permute_count(const std::size_t n, const std::size_t k) -> std::optional<std::uint64_t> {
+
+        if (k > n) {
+            return std::uint64_t{0};
+        }
+
+        auto count = std::uint64_t{1};
+        for (auto i = std::size_t{0}; i < k; ++i) {
+            if (!detail::checked_mixed_radix_step(count, n - i, 0)) {
+                return std::nullopt;
+            }
+        }
+
+        return count;
+    }
+
+    /// Returns the index of the partial permutation `[perm_begin, perm_end)` of the sorted range
+    /// of distinct elements `[begin, end)` in the order in which `k_permute()` enumerates them,
+    /// or an empty optional if this index is not representable as a `std::uint64_t`. Every
+    /// element of the partial permutation must be a distinct element of the range. The index is
+    /// the number whose digits in the factorial number system (in which the `i`th digit of a
+    /// `k`-element partial permutation of `n` elements has radix `n - i`) are the numbers of
+    /// unused elements less than each element of the partial permutation.
+
+    template <typename forward_it, typename input_it>
+    auto k_permute_rank(const forward_it begin, const forward_it end, input_it perm_begin, const input_it perm_end)
+        -> std::optional<std::uint64_t> {
+
+        KSR_ASSERT(detail::is_strictly_increasing(begin, end));
+
+        const auto n = narrow_cast<std::size_t>(std::distance(begin, end));
+        auto used = std::vector<forward_it>{};
+        auto rank = std::uint64_t{0};
+
+        for (; perm_begin != perm_end; ++perm_begin) {
+
+            const auto iter = std::lower_bound(begin, end, *perm_begin);
+            KSR_ASSERT(iter != end && !(*perm_begin < *iter));
+
+            auto digit = narrow_cast<std::size_t>(std::distance(begin, iter));
+            for (const auto& prior : used) {
+                KSR_ASSERT(prior != iter);
+                digit -= *prior < *iter ? 1 : 0;
+            }
+
+            if (!detail::checked_mixed_radix_step(rank, n - used.size(), digit)) {
+                return std::nullopt;
+            }
+
+            used.push_back(iter);
+        }
+
+        return rank;
+    }
+
+    template <
+        typename range_t, typename perm_t,
+        typename = std::enable_if_t<is_range_v<range_t> && is_range_v<perm_t>>
+    >
+    auto k_permute_rank(const range_t& range, const perm_t& perm) -> std::optional<std::uint64_t> {
+        return k_permute_rank(adl_begin(range), adl_end(range), adl_begin(perm), adl_end(perm));
+    }
+
+    /// Permutes the sorted range of distinct elements `[begin, end)` so that its first `k`
+    /// elements are the partial permutation with the given `index` in the order in which
+    /// `k_permute()` enumerates them (as per `k_permute_rank()`), and the rest remain sorted.
+    /// `index` must be less than `k_permute_count(n, k)`, where `n` is the size of the range.
+
+    template <typename bidir_it>
+    void k_permute_unrank(const bidir_it begin, const bidir_it end, const std::size_t k, std::uint64_t index) {
+
+        KSR_ASSERT(detail::is_strictly_increasing(begin, end));
+
+        const auto n = narrow_cast<std::size_t>(std::distance(begin, end));
+        KSR_ASSERT(k <= n);
+
+        // The digits are found least significant first, by repeated division, so no product of
+        // radices (which might overflow) is ever needed.
+
+        auto digits = std::vector<std::size_t>(k);
+        for (auto i = k; i-- > 0;) {
+            digits[i] = narrow_cast<std::size_t>(index % (n - i));
+            index /= n - i;
+        }
+
+        KSR_ASSERT(index == 0);
+
+        // Each element is rotated to the front of the unused elements, which remain sorted.
+
+        auto pos = begin;
+        for (const auto digit : digits) {
+            const auto chosen = std::next(pos, narrow_cast<std::ptrdiff_t>(digit));
+            std::rotate(pos, chosen, std::next(chosen));
+            ++pos;
+        }
+    }
+
+    template <typename range_t, typename = std::enable_if_t<is_range_v<range_t>>>
+    void k_permute_unrank(range_t& range, const std::size_t k, const std::uint64_t index) {
+        k_permute_unrank(adl_begin(range), adl_end(range), k, index);
+    }
+
+    /// Invokes `callback` on the `k`-element partial permutations of the sorted range of distinct
+    /// elements `[begin, end)` whose indices in the order in which `k_permute()` enumerates them
+    /// are in `[first_index, last_index)` (or, if there are fewer, up to the last), as per
+    /// `k_permute()`, and leaves the range sorted once more. This allows an enumeration to be
+    /// resumed or split into slices (e.g. to be run on different machines); the first partial
+    /// permutation is found as per `k_permute_unrank()`, after which each one takes amortised
+    /// constant time, as for `k_permute()`.
+
+    template <typename bidir_it, typename callback_t>
+    void k_permute_range(
+        const bidir_it begin, const bidir_it end, const std::size_t k,
+        const std::uint64_t first_index, const std::uint64_t last_index, callback_t callback) {
+
+        KSR_ASSERT(first_index <= last_index);
+
+        const auto count = k_permute_count(narrow_cast<std::size_t>(std::distance(begin, end)), k);
+        if (first_index >= last_index || (count && first_index >= *count)) {
+            return;
+        }
+
+        k_permute_unrank(begin, end, k, first_index);
+
+        auto remaining = last_index - first_index;
+        auto slice_callback = [&](const bidir_it slice_begin, const bidir_it slice_end) {
+            const auto control = detail::invoke_permute_callback(callback, slice_begin, slice_end);
+            return --remaining == 0 ? permute_control::stop : control;
+        };
+
+        detail::k_permute(begin, end, k, slice_callback);
+    }
+
+    template <typename range_t, typename callback_t, typename = std::enable_if_t<is_range_v<range_t>>>
+    void k_permute_range(
+        range_t& range, const std::size_t k,
+        const std::uint64_t first_index, const std::uint64_t last_index, callback_t callback) {
+
+        k_permute_range(adl_begin(range), adl_end(range), k, first_index, last_index, callback);
+    }
+
     /// Invokes `mutator` as if by `std::invoke()` on a copy of `value` alongside each item in the
     /// range `[begin, end)`, and returns the subsequent value of `value`. `mutator` must be a
     /// function object for which `std::invoke(mutator, value, rhs)` is well-formed when `rhs` is an
@@ -89,18 +1005,95 @@ namespace ksr {
         return mutate_for_each(adl_begin(range), adl_end(range), value, mutator);
     }
 
+    /// The orders in which `sub_permute()` may enumerate partial permutations: `by_size`, all
+    /// those of each size in turn (from the empty one to the full permutations), each size in
+    /// lexicographic order as per `k_permute()`; or `prefix_tree`, a depth-first traversal in
+    /// which each partial permutation is followed by its extensions, i.e. lexicographic order
+    /// over all sizes.
+
+    enum class sub_permute_order { by_size, prefix_tree };
+
+    namespace detail {
+
+        // Invokes callback on [begin, pos) and then on each extension of it by the elements of
+        // [pos, end), which are sorted (and are so again on return). Each distinct element is
+        // brought to pos in increasing order by swapping it with its predecessor, which keeps
+        // [pos + 1, end) sorted; the greatest is finally rotated back to the end. Returns false
+        // if the callback stopped the enumeration.
+
+        template <typename bidir_it, typename callback_t>
+        auto sub_permute_prefix_tree(const bidir_it begin, const bidir_it pos, const bidir_it end, callback_t& callback)
+            -> bool {
+
+            const auto control = invoke_permute_callback(callback, begin, pos);
+            if (control != permute_control::proceed || pos == end) {
+                return control != permute_control::stop;
+            }
+
+            const auto rest = std::next(pos);
+            auto next = rest;
+            for (;;) {
+
+                while (next != end && !(*pos < *next)) {
+                    ++next;
+                }
+
+                // The result is only tested if the callback can stop the enumeration, which
+                // spares void callbacks a test after every recursive call.
+
+                const auto proceed = sub_permute_prefix_tree(begin, rest, end, callback);
+                if constexpr (is_permute_controlled_v<callback_t, bidir_it>) {
+                    if (!proceed) {
+                        std::rotate(pos, rest, std::lower_bound(rest, end, *pos));
+                        return false;
+                    }
+                }
+
+                if (next == end) {
+                    break;
+                }
+
+                std::iter_swap(pos, next);
+            }
+
+            std::rotate(pos, rest, end);
+            return true;
+        }
+    }
+
     /// Invokes `callback` on each k-element partial permutation of the sorted range `[begin, end)`
-    /// for all values of `k` from zero to the size of this range, as per `k_permute()`.
+    /// for all values of `k` from zero to the size of this range, as per `k_permute()`, in the
+    /// given `order` (by default, `sub_permute_order::by_size`). The time taken is proportional
+    /// to the number of partial permutations enumerated; in `sub_permute_order::prefix_tree`,
+    /// `callback` may return `permute_control::skip_extensions` to prune a partial permutation,
+    /// at no further cost, which suits branch-and-bound searches.
 
     template <typename bidir_it, typename callback_t>
-    void sub_permute(const bidir_it begin, const bidir_it end, callback_t callback) {
+    void sub_permute(const bidir_it begin, const bidir_it end, const sub_permute_order order, callback_t callback) {
+
+        if (order == sub_permute_order::prefix_tree) {
+            detail::sub_permute_prefix_tree(begin, begin, end, callback);
+            return;
+        }
 
         const auto size = narrow_cast<std::size_t>(std::distance(begin, end));
         for (auto k = std::size_t{0}; k <= size; ++k) {
-            k_permute(begin, end, k, callback);
+            if (!detail::k_permute(begin, end, k, callback)) {
+                return;
+            }
         }
     }
 
+    template <typename bidir_it, typename callback_t>
+    void sub_permute(const bidir_it begin, const bidir_it end, callback_t callback) {
+        sub_permute(begin, end, sub_permute_order::by_size, callback);
+    }
+
+    template <typename range_t, typename callback_t, typename = std::enable_if_t<is_range_v<range_t>>>
+    void sub_permute(range_t& range, const sub_permute_order order, callback_t callback) {
+        sub_permute(adl_begin(range), adl_end(range), order, callback);
+    }
+
     template <typename range_t, typename callback_t, typename = std::enable_if_t<is_range_v<range_t>>>
     void sub_permute(range_t& range, callback_t callback) {
         sub_permute(adl_begin(range), adl_end(range), callback);
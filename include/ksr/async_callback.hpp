@@ -0,0 +1,136 @@
+#ifndef KSR_ASYNC_CALLBACK_HPP
+#define KSR_ASYNC_CALLBACK_HPP
+
+#include "dispatch_queue.hpp"
+#include "inplace_function.hpp"
+#include "triple_buffer.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ksr {
+
+    ///
+    /// A callback type for \ref basic_update_filter (or any other component that invokes a
+    /// callback with \p value_ts) that hands each invocation over to another thread, so that a
+    /// slow consumer never stalls the producer. The values are published through a
+    /// \ref triple_buffer and the wrapped function \p fn_t is then invoked with them on the
+    /// consumer's side, either by a \ref dispatch_queue (when drained) or by a user-supplied
+    /// executor.
+    ///
+    /// Invocations are coalesced: at most one delivery is outstanding at a time, and it delivers
+    /// the latest values published before it runs. If the consumer falls behind, intermediate
+    /// values are therefore dropped rather than queued, so memory use is fixed and the producer
+    /// never blocks; the last values published are always delivered. Publishing costs a copy of
+    /// the values and two atomic exchanges, plus a post when no delivery is outstanding.
+    ///
+    /// An executor is any object that can be called with an <tt>inplace_function<void()></tt>
+    /// task (which holds a single \c std::shared_ptr) and arranges for the task to be called
+    /// later, e.g. by a thread pool; it is stored in an \ref inplace_function, so must be small
+    /// (a reference wrapper or pointer to a larger object will do).
+    ///
+    /// Each \ref basic_async_callback owns a shared delivery state, allocated once on
+    /// construction and kept alive while a delivery is outstanding, so the callback (and the
+    /// filter containing it) may be destroyed at any time. It may be moved but not copied, as it
+    /// supports only a single producer. Calls to the wrapped function never overlap, even if the
+    /// executor runs tasks on several threads.
+    ///
+
+    template <typename fn_t, typename... value_ts>
+    class basic_async_callback {
+    public:
+
+        using task = inplace_function<void()>;
+
+        basic_async_callback(dispatch_queue& queue, fn_t fn)
+          : m_state{std::make_shared<state>(std::move(fn))} {
+
+            m_state->post = [&queue](state& self) {
+                self.keep_alive = self.shared_from_this();
+                queue.post(self);
+            };
+        }
+
+        template <
+            typename executor_t,
+            typename = std::enable_if_t<std::is_invocable_v<executor_t&, task>>
+        >
+        basic_async_callback(executor_t executor, fn_t fn)
+          : m_state{std::make_shared<state>(std::move(fn))} {
+
+            m_state->post = [executor = std::move(executor)](state& self) mutable {
+                executor(task{[shared_self = self.shared_from_this()] { shared_self->deliver(); }});
+            };
+        }
+
+        basic_async_callback(basic_async_callback&&) noexcept = default;
+        auto operator=(basic_async_callback&&) noexcept -> basic_async_callback& = default;
+
+        void operator()(const value_ts&... values) {
+            m_state->publish(values...);
+        }
+
+    private:
+
+        struct state : public dispatch_queue::node, public std::enable_shared_from_this<state> {
+
+            explicit state(fn_t fn)
+              : dispatch_queue::node{&run}, fn{std::move(fn)} {}
+
+            static void run(dispatch_queue::node& item) {
+                auto& self = static_cast<state&>(item);
+                const auto shared_self = std::move(self.keep_alive);
+                self.deliver();
+            }
+
+            void publish(const value_ts&... values) {
+
+                values_buffer.write(std::tie(values...));
+
+                if (!scheduled.exchange(true)) {
+                    post(*this);
+                }
+            }
+
+            void deliver() {
+
+                // The flag is only cleared once the values taken have been delivered, so that
+                // deliveries never overlap. If values published meanwhile are then found, the
+                // producer may or may not have seen the flag still set; whichever side reclaims
+                // it delivers them.
+
+                for (;;) {
+
+                    if (values_buffer.take(latest)) {
+                        std::apply(fn, latest);
+                    }
+
+                    scheduled.store(false);
+
+                    if (!values_buffer.pending() || scheduled.exchange(true)) {
+                        return;
+                    }
+                }
+            }
+
+            fn_t fn;
+            inplace_function<void(state&)> post;
+            std::shared_ptr<state> keep_alive;
+
+            triple_buffer<std::tuple<value_ts...>> values_buffer;
+            std::tuple<value_ts...> latest;
+            std::atomic<bool> scheduled{false};
+        };
+
+        std::shared_ptr<state> m_state;
+    };
+
+    template <typename... value_ts>
+    using async_callback = basic_async_callback<std::function<void(value_ts...)>, value_ts...>;
+}
+
+#endif
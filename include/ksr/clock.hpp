@@ -0,0 +1,170 @@
+#ifndef KSR_CLOCK_HPP
+#define KSR_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define KSR_HAS_TSC_CLOCK
+#endif
+
+namespace ksr {
+
+    ///
+    /// A steady clock meeting the standard \c Clock requirements that reads
+    /// \c CLOCK_MONOTONIC_COARSE where it is available (falling back to \c std::chrono::steady_clock
+    /// elsewhere). The coarse clock is typically read from the vDSO without a system call, at the
+    /// cost of a resolution of one scheduler tick (commonly 1-4ms); this is ample for rate-limiting
+    /// notifications at intervals of tens of milliseconds.
+    ///
+
+    struct coarse_steady_clock {
+
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<coarse_steady_clock>;
+        static constexpr auto is_steady = true;
+
+        static auto now() noexcept -> time_point {
+#if defined(CLOCK_MONOTONIC_COARSE)
+            auto ts = timespec{};
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+            return time_point{std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec}};
+#else
+            const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+            return time_point{std::chrono::duration_cast<duration>(since_epoch)};
+#endif
+        }
+    };
+
+#ifdef KSR_HAS_TSC_CLOCK
+
+    ///
+    /// A steady clock meeting the standard \c Clock requirements that reads the processor's
+    /// time-stamp counter, scaled to nanoseconds by a factor calibrated against
+    /// \c std::chrono::steady_clock. Reading the counter costs a few tens of cycles, with no
+    /// system call or vDSO indirection. Only available (as indicated by \c KSR_HAS_TSC_CLOCK) on
+    /// x86 targets, and only meaningful on processors with an invariant TSC (which covers every
+    /// x86-64 processor of the last decade).
+    ///
+    /// Calibration blocks the calling thread for a few milliseconds; it takes place on the first
+    /// call to now(), or may be performed up front by calling calibrate().
+    ///
+
+    struct tsc_clock {
+
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<tsc_clock>;
+        static constexpr auto is_steady = true;
+
+        static auto now() noexcept -> time_point {
+            const auto ticks = static_cast<double>(__rdtsc());
+            return time_point{duration{static_cast<rep>(ticks * ns_per_tick())}};
+        }
+
+        static void calibrate() noexcept {
+            static_cast<void>(ns_per_tick());
+        }
+
+    private:
+
+        static auto ns_per_tick() noexcept -> double {
+
+            static const auto result = [] {
+
+                using namespace std::chrono_literals;
+
+                const auto start_time = std::chrono::steady_clock::now();
+                const auto start_ticks = __rdtsc();
+                std::this_thread::sleep_for(10ms);
+                const auto end_ticks = __rdtsc();
+                const auto end_time = std::chrono::steady_clock::now();
+
+                const auto elapsed = std::chrono::duration<double, std::nano>{end_time - start_time};
+                return elapsed.count() / static_cast<double>(end_ticks - start_ticks);
+            }();
+
+            return result;
+        }
+    };
+
+#endif
+
+    ///
+    /// Adapts another clock so that the underlying clock is only read on every \p n-th call to
+    /// now(); the other calls return the time last read. This bounds the cost of reading the clock
+    /// in a hot loop to a counter increment most of the time, at the expense of time appearing to
+    /// stand still for up to \p n - 1 calls. Unlike the other clocks here, now() is a non-static
+    /// member function, so each \ref every_nth_clock object counts its own calls (and is not
+    /// thread-safe).
+    ///
+
+    template <typename chrono_clock_t, unsigned n>
+    class every_nth_clock {
+    public:
+
+        static_assert(n > 0);
+
+        using rep = typename chrono_clock_t::rep;
+        using period = typename chrono_clock_t::period;
+        using duration = typename chrono_clock_t::duration;
+        using time_point = typename chrono_clock_t::time_point;
+        static constexpr auto is_steady = chrono_clock_t::is_steady;
+
+        auto now() noexcept -> time_point {
+
+            if (m_countdown == 0) {
+                m_countdown = n;
+                m_time = chrono_clock_t::now();
+            }
+
+            --m_countdown;
+            return m_time;
+        }
+
+    private:
+
+        unsigned m_countdown = 0;
+        time_point m_time;
+    };
+
+    ///
+    /// A clock meeting the standard \c Clock requirements whose time only changes when explicitly
+    /// set or advanced. Intended for tests of time-dependent components, which can then run without
+    /// sleeping or depending on scheduling. The time is shared by all users of the clock and starts
+    /// at the epoch.
+    ///
+
+    struct manual_clock {
+
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<manual_clock>;
+        static constexpr auto is_steady = false;
+
+        static auto now() noexcept -> time_point {
+            return s_now;
+        }
+
+        static void set(const time_point time) noexcept {
+            s_now = time;
+        }
+
+        static void advance(const duration interval) noexcept {
+            s_now += interval;
+        }
+
+    private:
+
+        inline static auto s_now = time_point{};
+    };
+}
+
+#endif
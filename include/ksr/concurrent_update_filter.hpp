@@ -0,0 +1,382 @@
+#ifndef KSR_CONCURRENT_UPDATE_FILTER_HPP
+#define KSR_CONCURRENT_UPDATE_FILTER_HPP
+
+#include "math.hpp"
+#include "seqlock.hpp"
+#include "update_filter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ksr {
+
+    namespace detail {
+
+        template <typename... value_ts>
+        auto load_relaxed(const std::tuple<std::atomic<value_ts>...>& values) -> std::tuple<value_ts...> {
+            return std::apply([](const auto&... value) {
+                return std::tuple<value_ts...>{value.load(std::memory_order_relaxed)...};
+            }, values);
+        }
+
+        template <typename... value_ts>
+        void store_relaxed(std::tuple<std::atomic<value_ts>...>& values, const value_ts&... new_values) {
+            std::apply([&](auto&... value) {
+                (value.store(new_values, std::memory_order_relaxed), ...);
+            }, values);
+        }
+    }
+
+    ///
+    /// A counterpart of \ref basic_update_filter on which update() and sync() may be called from
+    /// any number of threads at once, without external locking. Rather than can_update(), policies
+    /// for a \ref basic_concurrent_update_filter provide
+    /// ```c++
+    /// bool try_claim(
+    ///     const std::tuple<std::atomic<value_ts>...>& current_values,
+    ///     const std::tuple<value_ts...>& new_values)
+    /// void claim(const std::tuple<value_ts...>& new_values)
+    /// ```
+    /// try_claim() must be safe to call concurrently and must return \c true for exactly one of any
+    /// set of racing calls that would each cross the same threshold (typically by means of a CAS on
+    /// the policy's own state); claim() records \p new_values as actioned unconditionally, for
+    /// sync(). The policies in \c filter_policy::concurrent_int_fraction and
+    /// \c filter_policy::concurrent_sampled reject updates that cannot cross a threshold without
+    /// any atomic read-modify-write (using atomic loads only, except for the clock read of the
+    /// latter).
+    ///
+    /// Every \p value_ts type must be trivially copyable, as the last-actioned data are stored in
+    /// individual \c std::atomic objects. ksr::get() and decomposition declarations therefore yield
+    /// copies of each element, each of which is read atomically; elements actioned by different
+    /// threads in quick succession may be observed from different updates.
+    ///
+    /// The callback is invoked on the thread whose update crossed the threshold. If successive
+    /// thresholds are crossed by different threads in quick succession, the callback may run
+    /// concurrently with itself (and so must be thread-safe), and the invocations may complete in
+    /// either order.
+    ///
+
+    template <template <typename...> class policy, typename callback_t, typename... value_ts>
+    class basic_concurrent_update_filter : public policy<value_ts...> {
+    private:
+
+        using policy_t = policy<value_ts...>;
+        static_assert((std::is_trivially_copyable_v<value_ts> && ...));
+
+    public:
+
+        template <std::size_t index>
+        friend auto adl_get(const basic_concurrent_update_filter& self) {
+            return std::get<index>(self.m_last_values).load(std::memory_order_relaxed);
+        }
+
+        explicit basic_concurrent_update_filter(callback_t update)
+          : m_update{std::move(update)} {}
+
+        template <typename t>
+        explicit basic_concurrent_update_filter(const t& policy_data, callback_t update)
+          : policy_t{policy_data}, m_update{std::move(update)} {}
+
+        explicit basic_concurrent_update_filter(
+            update_filter_tag<policy, value_ts...>, callback_t update)
+          : m_update{std::move(update)} {}
+
+        template <typename t>
+        explicit basic_concurrent_update_filter(
+            update_filter_tag<policy, value_ts...>, const t& policy_data, callback_t update)
+          : policy_t{policy_data}, m_update{std::move(update)} {}
+
+        basic_concurrent_update_filter(const basic_concurrent_update_filter&) = delete;
+        auto operator=(const basic_concurrent_update_filter&) -> basic_concurrent_update_filter& = delete;
+
+        ///
+        /// As for basic_update_filter::sync(); may race with other calls to sync() and update().
+        ///
+
+        void sync(const value_ts&... new_values) {
+            policy_t::claim(std::tuple<value_ts...>{new_values...});
+            detail::store_relaxed(m_last_values, new_values...);
+            m_update(new_values...);
+        }
+
+        ///
+        /// As for basic_update_filter::update(); may race with other calls to sync() and update().
+        /// Returns \c true on the one thread that claimed the update and invoked the callback.
+        ///
+
+        auto update(const value_ts&... new_values) -> bool {
+
+            if (!policy_t::try_claim(m_last_values, std::tuple<value_ts...>{new_values...})) {
+                return false;
+            }
+
+            detail::store_relaxed(m_last_values, new_values...);
+            m_update(new_values...);
+            return true;
+        }
+
+    private:
+
+        callback_t m_update;
+        std::tuple<std::atomic<value_ts>...> m_last_values{};
+    };
+
+    template <template <typename...> class policy, typename... value_ts, typename callback_t>
+    basic_concurrent_update_filter(update_filter_tag<policy, value_ts...>, callback_t)
+        -> basic_concurrent_update_filter<policy, callback_t, value_ts...>;
+
+    template <
+        template <typename...> class policy, typename... value_ts,
+        typename t, typename callback_t
+    >
+    basic_concurrent_update_filter(update_filter_tag<policy, value_ts...>, const t&, callback_t)
+        -> basic_concurrent_update_filter<policy, callback_t, value_ts...>;
+
+    template <template <typename...> class policy, typename... value_ts>
+    using concurrent_update_filter =
+        basic_concurrent_update_filter<policy, std::function<void(value_ts...)>, value_ts...>;
+
+    namespace filter_policy {
+
+        ///
+        /// Concurrent counterpart of \ref int_fraction. The last-actioned fraction is the single
+        /// point of synchronisation: an update is accepted by whichever thread manages to raise it
+        /// via CAS.
+        ///
+        /// For integral \p count_t, the winning thread also publishes the threshold count for the
+        /// new fraction under a seqlock, so that (just as for the sequential policy) an update that
+        /// cannot raise the fraction is rejected after a handful of atomic loads and an integer
+        /// comparison. The published threshold is only trusted while it was computed for the
+        /// current fraction and the same total; in any other case, the fraction is computed and
+        /// compared exactly.
+        ///
+        /// As for the sequential policy, whose initial data are 0/0, every update is accepted while
+        /// the last-actioned total is zero, and a zero total is only valid in that state.
+        ///
+
+        template <int scale_v>
+        struct concurrent_int_fraction {
+
+            static_assert(scale_v > 0);
+
+            template <
+                typename count_t,
+                typename total_t,
+                typename = std::enable_if_t<
+                    std::is_same_v<count_t, total_t> &&
+                    std::is_arithmetic_v<count_t>>
+            >
+            class policy {
+            public:
+
+                static constexpr auto scale = scale_v;
+
+            protected:
+
+                auto try_claim(
+                    const std::tuple<std::atomic<count_t>, std::atomic<total_t>>&,
+                    const std::tuple<count_t, total_t>& new_values) -> bool {
+
+                    const auto& [new_count, new_total] = new_values;
+
+                    // The CAS orders this update with any racing ones that raise the fraction.
+
+                    if (new_total == total_t{}) {
+                        auto fraction = no_fraction;
+                        const auto accepted = m_fraction.compare_exchange_strong(
+                            fraction, no_fraction, std::memory_order_relaxed);
+                        KSR_ASSERT(accepted);
+                        return accepted;
+                    }
+
+                    if constexpr (std::is_integral_v<count_t>) {
+                        if (below_threshold(new_count, new_total)) {
+                            return false;
+                        }
+                    }
+
+                    const auto new_fraction = ksr::int_fraction<scale>(new_count, new_total);
+                    auto fraction = m_fraction.load(std::memory_order_relaxed);
+
+                    do {
+                        if (new_fraction <= fraction) {
+                            return false;
+                        }
+                    } while (!m_fraction.compare_exchange_weak(
+                        fraction, new_fraction, std::memory_order_relaxed));
+
+                    if constexpr (std::is_integral_v<count_t>) {
+                        publish_threshold(new_fraction, new_count, new_total);
+                    }
+
+                    return true;
+                }
+
+                void claim(const std::tuple<count_t, total_t>& new_values) {
+
+                    const auto& [new_count, new_total] = new_values;
+                    const auto new_fraction =
+                        new_total != total_t{} ? ksr::int_fraction<scale>(new_count, new_total) : no_fraction;
+                    m_fraction.store(new_fraction, std::memory_order_relaxed);
+
+                    if constexpr (std::is_integral_v<count_t>) {
+                        publish_threshold(new_fraction, new_count, new_total);
+                    }
+                }
+
+            private:
+
+                // Sentinel for the fraction while the last-actioned total is zero (as it is before
+                // any update), below any fraction that can be computed, so that the next update is
+                // always accepted.
+
+                static constexpr auto no_fraction = INT_MIN;
+
+                auto below_threshold(const count_t count, const total_t total) const -> bool {
+
+                    const auto threshold = m_threshold.try_read();
+                    if (!threshold) {
+                        return false;
+                    }
+
+                    const auto [fraction, threshold_total, next_count] = *threshold;
+                    return
+                        total == threshold_total &&
+                        count < next_count &&
+                        fraction == m_fraction.load(std::memory_order_relaxed);
+                }
+
+                ///
+                /// Publishes the threshold for \p fraction of \p total (as computed from \p count).
+                /// Only one thread publishes at a time: a thread that finds another publication in
+                /// progress simply leaves the fast path to the other thread, and a threshold whose
+                /// fraction has been superseded by the time it is read is ignored by readers.
+                ///
+
+                void publish_threshold(const int fraction, const count_t count, const total_t total) {
+
+                    const auto next_count = detail::next_fraction_count<scale>(count, total);
+                    if (next_count && m_fraction.load(std::memory_order_relaxed) == fraction) {
+                        m_threshold.try_publish(fraction, total, *next_count);
+                    }
+                }
+
+                std::atomic<int> m_fraction{no_fraction};
+                detail::seqlock_words<int, total_t, count_t> m_threshold;
+            };
+        };
+
+        template <typename count_t, typename total_t>
+        using concurrent_int_percentage =
+            typename concurrent_int_fraction<100>::template policy<count_t, total_t>;
+
+        ///
+        /// Concurrent counterpart of \ref basic_sampled. The time of the last actioned update is
+        /// stored atomically, and an update is accepted by whichever thread manages to advance it
+        /// via CAS once the interval has elapsed.
+        ///
+        /// An update equal to the last-actioned data is rejected using atomic loads only. Any
+        /// other update also reads \p chrono_clock_t, since only the clock can tell whether the
+        /// interval has elapsed, but makes no atomic read-modify-write unless it has.
+        /// \c chrono_clock_t::now() must be safe to call concurrently, so (unlike for
+        /// basic_sampled) \ref every_nth_clock cannot be used; \ref coarse_steady_clock or
+        /// \ref tsc_clock make the clock read cheaper where a coarser or calibrated time suffices.
+        ///
+
+        template <typename chrono_clock_t>
+        struct basic_concurrent_sampled {
+
+            template <typename... value_ts>
+            class policy {
+            protected:
+
+                explicit policy(const std::chrono::milliseconds interval)
+                  : m_interval{std::chrono::duration_cast<duration>(interval).count()} {}
+
+                auto try_claim(
+                    const std::tuple<std::atomic<value_ts>...>& current_values,
+                    const std::tuple<value_ts...>& new_values) -> bool {
+
+                    if (detail::load_relaxed(current_values) == new_values) {
+                        return false;
+                    }
+
+                    const auto now = chrono_clock_t::now().time_since_epoch().count();
+                    auto last = m_last_update_time.load(std::memory_order_relaxed);
+
+                    do {
+                        if (last != never && now - last < m_interval) {
+                            return false;
+                        }
+                    } while (!m_last_update_time.compare_exchange_weak(
+                        last, now, std::memory_order_relaxed));
+
+                    return true;
+                }
+
+                void claim(const std::tuple<value_ts...>&) {
+                    m_last_update_time.store(
+                        chrono_clock_t::now().time_since_epoch().count(), std::memory_order_relaxed);
+                }
+
+            private:
+
+                using duration = typename chrono_clock_t::duration;
+                using rep = typename duration::rep;
+
+                static constexpr auto never = std::numeric_limits<rep>::min();
+
+                rep m_interval;
+                std::atomic<rep> m_last_update_time{never};
+            };
+        };
+
+        template <typename... value_ts>
+        using concurrent_sampled =
+            typename basic_concurrent_sampled<std::chrono::steady_clock>::template policy<value_ts...>;
+    }
+
+    template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
+    using concurrent_int_percentage_filter =
+        concurrent_update_filter<filter_policy::concurrent_int_percentage, num_t, num_t>;
+
+    template <typename... value_ts>
+    using concurrent_sampled_filter = concurrent_update_filter<filter_policy::concurrent_sampled, value_ts...>;
+
+    template <typename chrono_clock_t, typename... value_ts>
+    using basic_concurrent_sampled_filter = concurrent_update_filter<
+        filter_policy::basic_concurrent_sampled<chrono_clock_t>::template policy, value_ts...>;
+}
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmismatched-tags"
+#endif
+
+namespace std {
+
+    template <
+        std::size_t index,
+        template <typename...> class policy_t, typename callback_t, typename... value_ts
+    >
+    struct tuple_element<index, ksr::basic_concurrent_update_filter<policy_t, callback_t, value_ts...>> {
+        using type = std::tuple_element_t<index, std::tuple<value_ts...>>;
+    };
+
+    template <template <typename...> class policy_t, typename callback_t, typename... value_ts>
+    struct tuple_size<ksr::basic_concurrent_update_filter<policy_t, callback_t, value_ts...>>
+        : public std::integral_constant<std::size_t, sizeof...(value_ts)> {};
+}
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef KSR_DISPATCH_QUEUE_HPP
+#define KSR_DISPATCH_QUEUE_HPP
+
+#include "inplace_function.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ksr {
+
+    ///
+    /// A lock-free multiple-producer, single-consumer queue of work items, through which any number
+    /// of producer threads can hand work to one consumer thread (such as a UI thread) without
+    /// blocking. The queue is intrusive: each item is a \ref dispatch_queue::node owned by the
+    /// producer, so posting never allocates, and a node may be posted again once the consumer has
+    /// run it. Posting is wait-free (a single atomic exchange); the consumer runs posted items,
+    /// in the order they were posted, by calling drain().
+    ///
+    /// An optional notification function passed to the constructor is called (on the producer's
+    /// thread) after each post, which may be used to wake the consumer, e.g. by queueing a call to
+    /// drain() on an event loop.
+    ///
+
+    class dispatch_queue {
+    public:
+
+        ///
+        /// An item that may be posted to a \ref dispatch_queue; \p run is called with the node
+        /// when the consumer reaches it. A node must not be posted again until it has been run.
+        ///
+
+        class node {
+        public:
+
+            explicit node(void (*run)(node&)) noexcept
+              : m_run{run} {}
+
+            node(const node&) = delete;
+            auto operator=(const node&) -> node& = delete;
+
+        private:
+
+            friend class dispatch_queue;
+
+            std::atomic<node*> m_next{nullptr};
+            void (*m_run)(node&);
+        };
+
+        explicit dispatch_queue(inplace_function<void()> notify = {})
+          : m_notify{std::move(notify)} {}
+
+        dispatch_queue(const dispatch_queue&) = delete;
+        auto operator=(const dispatch_queue&) -> dispatch_queue& = delete;
+
+        ///
+        /// Runs any items still queued, so that no node is left referring to the queue.
+        ///
+
+        ~dispatch_queue() {
+            drain();
+        }
+
+        void post(node& item) {
+
+            push(item);
+
+            if (m_notify) {
+                m_notify();
+            }
+        }
+
+        ///
+        /// Runs up to \p max_items queued items on the calling thread, returning the number run.
+        /// Only one thread may call drain() at a time. Items posted while draining are also run,
+        /// subject to \p max_items, which can be used to bound the time spent when producers post
+        /// continuously.
+        ///
+
+        auto drain(const std::size_t max_items = SIZE_MAX) -> std::size_t {
+
+            auto count = std::size_t{0};
+            for (; count < max_items; ++count) {
+
+                const auto item = pop();
+                if (!item) {
+                    break;
+                }
+
+                item->m_run(*item);
+            }
+
+            return count;
+        }
+
+    private:
+
+        // This is Vyukov's intrusive MPSC queue: producers exchange themselves into m_head and
+        // then link the previous head to themselves, while the consumer follows the links from
+        // m_tail. A stub node keeps the list non-empty, so that the consumer never needs to
+        // update m_head.
+
+        void push(node& item) noexcept {
+            item.m_next.store(nullptr, std::memory_order_relaxed);
+            const auto prev = m_head.exchange(&item, std::memory_order_acq_rel);
+            prev->m_next.store(&item, std::memory_order_release);
+        }
+
+        auto pop() noexcept -> node* {
+
+            auto tail = m_tail;
+            auto next = tail->m_next.load(std::memory_order_acquire);
+
+            if (tail == &m_stub) {
+
+                if (!next) {
+                    return nullptr;
+                }
+
+                m_tail = next;
+                tail = next;
+                next = next->m_next.load(std::memory_order_acquire);
+            }
+
+            if (next) {
+                m_tail = next;
+                return tail;
+            }
+
+            // tail is the last linked node. If it isn't also the head, a producer is part way
+            // through push(): the item will be reachable once it has finished, and as the
+            // notification follows the push, the consumer will be told to drain again.
+
+            if (tail != m_head.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+
+            push(m_stub);
+
+            next = tail->m_next.load(std::memory_order_acquire);
+            if (next) {
+                m_tail = next;
+                return tail;
+            }
+
+            return nullptr;
+        }
+
+        node m_stub{nullptr};
+        std::atomic<node*> m_head{&m_stub};
+        node* m_tail = &m_stub;
+        inplace_function<void()> m_notify;
+    };
+}
+
+#endif
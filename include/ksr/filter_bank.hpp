@@ -0,0 +1,421 @@
+#ifndef KSR_FILTER_BANK_HPP
+#define KSR_FILTER_BANK_HPP
+
+#include "error.hpp"
+#include "math.hpp"
+#include "simd_find.hpp"
+#include "update_filter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace ksr {
+
+    ///
+    /// The bitmap through which the dense update() overloads of the filter banks report which
+    /// filters fired: bit \c j of word \c j/64 is set if the \c j-th filter of the range fired.
+    ///
+
+    using filter_bank_bitmap = std::vector<std::uint64_t>;
+
+    namespace detail {
+
+        inline constexpr auto bank_block_size = std::size_t{64};
+
+        ///
+        /// Drives the dense update of a filter bank: \p decide is called for each block of up to
+        /// 64 consecutive filters and returns a mask of those that fire (which it should compute
+        /// with SIMD instructions, as bank_mask_at_least() does, or else in a simple loop over the
+        /// block, free of branches, that the compiler can vectorise), and then \p action is called
+        /// for each filter that fired. The masks are stored in
+        /// \p fired, and the number of filters that fired is returned.
+        ///
+
+        template <typename decide_t, typename action_t>
+        auto bank_update_dense(
+            const std::size_t count, filter_bank_bitmap& fired, decide_t decide, action_t action) -> std::size_t {
+
+            fired.assign((count + bank_block_size - 1) / bank_block_size, 0);
+
+            auto fired_count = std::size_t{0};
+            for (auto block = std::size_t{0}; block * bank_block_size < count; ++block) {
+
+                const auto begin = block * bank_block_size;
+                auto bits = decide(begin, std::min(bank_block_size, count - begin));
+                fired[block] = bits;
+
+                // Firing is the exception, so blocks in which nothing fired cost only the test.
+
+                for (auto j = std::size_t{0}; bits != 0; ++j, bits >>= 1) {
+                    if (bits & 1) {
+                        action(begin + j);
+                        ++fired_count;
+                    }
+                }
+            }
+
+            return fired_count;
+        }
+    }
+
+    namespace detail {
+
+        template <typename t>
+        auto bank_mask_at_least_loop(const t* const counts, const t* const thresholds, const std::size_t size)
+            -> std::uint64_t {
+
+            auto bits = std::uint64_t{0};
+            for (auto j = std::size_t{0}; j < size; ++j) {
+                bits |= std::uint64_t{counts[j] >= thresholds[j]} << j;
+            }
+            return bits;
+        }
+
+        template <typename t>
+        inline constexpr auto is_bank_simd_comparable_v =
+            std::is_integral_v<t> && !std::is_same_v<t, bool> && (sizeof(t) == 4 || sizeof(t) == 8);
+
+#ifdef KSR_HAS_SIMD_FIND
+
+        // The comparisons are signed, so unsigned elements are compared with their top bits
+        // flipped. SSE2 also lacks a 64-bit comparison, so it compares the halves of each
+        // quadword, the low halves as unsigned: a quadword is greater if its high half is, or if
+        // the high halves are equal and its low half is.
+
+        template <typename t>
+        inline auto bank_flip_sse2() -> __m128i {
+            if constexpr (sizeof(t) == 4) {
+                return _mm_set1_epi32(std::is_signed_v<t> ? 0 : INT32_MIN);
+            } else {
+                return _mm_set1_epi64x((std::is_signed_v<t> ? 0 : INT64_MIN) | std::int64_t{0x80000000});
+            }
+        }
+
+        template <typename t>
+        auto bank_mask_at_least_sse2(const t* const counts, const t* const thresholds, const std::size_t size)
+            -> std::uint64_t {
+
+            constexpr auto lanes = std::size_t{16} / sizeof(t);
+            constexpr auto all_lanes = (1 << lanes) - 1;
+            const auto flip = bank_flip_sse2<t>();
+
+            auto bits = std::uint64_t{0};
+            auto j = std::size_t{0};
+            for (; j + lanes <= size; j += lanes) {
+
+                const auto count = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + j)), flip);
+                const auto threshold = _mm_xor_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(thresholds + j)), flip);
+
+                auto below = 0;
+                if constexpr (sizeof(t) == 4) {
+                    below = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(threshold, count)));
+                } else {
+                    const auto greater = _mm_cmpgt_epi32(threshold, count);
+                    const auto equal = _mm_cmpeq_epi32(threshold, count);
+                    const auto high_greater = _mm_shuffle_epi32(greater, _MM_SHUFFLE(3, 3, 1, 1));
+                    const auto high_equal = _mm_shuffle_epi32(equal, _MM_SHUFFLE(3, 3, 1, 1));
+                    const auto low_greater = _mm_shuffle_epi32(greater, _MM_SHUFFLE(2, 2, 0, 0));
+                    below = _mm_movemask_pd(_mm_castsi128_pd(
+                        _mm_or_si128(high_greater, _mm_and_si128(high_equal, low_greater))));
+                }
+
+                bits |= static_cast<std::uint64_t>(~below & all_lanes) << j;
+            }
+
+            return bits | bank_mask_at_least_loop(counts + j, thresholds + j, size - j) << j;
+        }
+
+        template <typename t>
+        __attribute__((target("avx2"))) auto bank_mask_at_least_avx2(
+            const t* const counts, const t* const thresholds, const std::size_t size) -> std::uint64_t {
+
+            constexpr auto lanes = std::size_t{32} / sizeof(t);
+            constexpr auto all_lanes = (1 << lanes) - 1;
+            const auto flip = sizeof(t) == 4
+                ? _mm256_set1_epi32(std::is_signed_v<t> ? 0 : INT32_MIN)
+                : _mm256_set1_epi64x(std::is_signed_v<t> ? 0 : INT64_MIN);
+
+            auto bits = std::uint64_t{0};
+            auto j = std::size_t{0};
+            for (; j + lanes <= size; j += lanes) {
+
+                const auto count = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + j)), flip);
+                const auto threshold = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(thresholds + j)), flip);
+
+                const auto below = sizeof(t) == 4
+                    ? _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(threshold, count)))
+                    : _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(threshold, count)));
+
+                bits |= static_cast<std::uint64_t>(~below & all_lanes) << j;
+            }
+
+            return bits | bank_mask_at_least_sse2(counts + j, thresholds + j, size - j) << j;
+        }
+
+#endif
+
+        ///
+        /// The mask of those of the \p size (at most 64) elements of \p counts that are at least
+        /// the corresponding elements of \p thresholds. For 32- and 64-bit integers on x86, the
+        /// elements are compared by SSE2 or (where the processor supports it, as detected at run
+        /// time) AVX2 instructions, which a plain loop would only be compiled to for a target
+        /// with SSE4.2 or AVX2 (as SSE2 has no 64-bit comparison); otherwise, by that loop.
+        ///
+
+        template <typename t>
+        auto bank_mask_at_least(const t* const counts, const t* const thresholds, const std::size_t size)
+            -> std::uint64_t {
+
+#ifdef KSR_HAS_SIMD_FIND
+            if constexpr (is_bank_simd_comparable_v<t>) {
+                return has_avx2()
+                    ? bank_mask_at_least_avx2(counts, thresholds, size)
+                    : bank_mask_at_least_sse2(counts, thresholds, size);
+            } else {
+                return bank_mask_at_least_loop(counts, thresholds, size);
+            }
+#else
+            return bank_mask_at_least_loop(counts, thresholds, size);
+#endif
+        }
+    }
+
+    ///
+    /// Stores many filters that behave like \ref update_filter instances with the
+    /// filter_policy::int_fraction<scale> policy (e.g. one per file of a large scan) in
+    /// contiguous columns of last-actioned counts, totals and thresholds, rather than as separate
+    /// objects scattered across the heap. Filters are identified by their index in the bank, in
+    /// order of addition.
+    ///
+    /// Rather than invoking a callback, update() reports which filters fired: either by writing
+    /// their indices to an output iterator (for updates to an arbitrary set of filters), or as a
+    /// \ref filter_bank_bitmap (for updates to a range of consecutive filters). As for the
+    /// policy's fast path, each decision is a single comparison of the new count against the
+    /// filter's precomputed threshold; in the dense form those comparisons run over contiguous
+    /// arrays, several at a time (for 32- and 64-bit counts on x86, by SSE2 or AVX2 instructions
+    /// chosen at run time, whatever the target; see detail::bank_mask_at_least()).
+    ///
+    /// A filter's first update always fires, as does the first update after set_total().
+    /// Filters with a non-positive total never fire.
+    ///
+
+    template <int scale, typename count_t = std::int64_t>
+    class fraction_filter_bank {
+    public:
+
+        static_assert(std::is_integral_v<count_t>);
+
+        using id_type = std::size_t;
+
+        auto add(const count_t total) -> id_type {
+            m_counts.push_back(count_t{});
+            m_totals.push_back(total);
+            m_thresholds.push_back(first_threshold(total));
+            return m_counts.size() - 1;
+        }
+
+        auto size() const noexcept -> std::size_t {
+            return m_counts.size();
+        }
+
+        ///
+        /// The count with which filter \p id last fired (or zero if it has not yet fired).
+        ///
+
+        auto count(const id_type id) const -> count_t {
+            return m_counts[id];
+        }
+
+        auto total(const id_type id) const -> count_t {
+            return m_totals[id];
+        }
+
+        ///
+        /// The integer fraction of filter \p id's last-actioned count.
+        ///
+
+        auto fraction(const id_type id) const -> int {
+            return m_totals[id] > 0 ? ksr::int_fraction<scale>(m_counts[id], m_totals[id]) : 0;
+        }
+
+        void set_total(const id_type id, const count_t total) {
+            m_totals[id] = total;
+            m_thresholds[id] = first_threshold(total);
+        }
+
+        ///
+        /// Updates the filters whose indices are in [\p ids_first, \p ids_last) with the counts
+        /// starting at \p counts_first, writing the index of each filter that fires to \p fired.
+        ///
+
+        template <typename id_iter_t, typename count_iter_t, typename out_iter_t>
+        auto update(id_iter_t ids_first, const id_iter_t ids_last, count_iter_t counts_first, out_iter_t fired)
+            -> out_iter_t {
+
+            for (; ids_first != ids_last; ++ids_first, ++counts_first) {
+
+                const auto id = static_cast<id_type>(*ids_first);
+                const auto new_count = static_cast<count_t>(*counts_first);
+
+                if (new_count >= m_thresholds[id]) {
+                    fire(id, new_count);
+                    *fired++ = id;
+                }
+            }
+
+            return fired;
+        }
+
+        ///
+        /// Updates the consecutive filters starting at index \p first with the counts in
+        /// [\p counts_first, \p counts_last), setting the corresponding bits of \p fired for the
+        /// filters that fire. Returns the number of filters that fired.
+        ///
+
+        auto update(const id_type first, const count_t* const counts_first, const count_t* const counts_last,
+            filter_bank_bitmap& fired) -> std::size_t {
+
+            const auto count = static_cast<std::size_t>(counts_last - counts_first);
+            KSR_ASSERT(first + count <= size());
+
+            const auto thresholds = m_thresholds.data() + first;
+
+            return detail::bank_update_dense(count, fired,
+                [&](const std::size_t begin, const std::size_t size) {
+                    return detail::bank_mask_at_least(counts_first + begin, thresholds + begin, size);
+                },
+                [&](const std::size_t index) {
+                    fire(first + index, counts_first[index]);
+                });
+        }
+
+    private:
+
+        using limits = std::numeric_limits<count_t>;
+
+        static auto first_threshold(const count_t total) -> count_t {
+            return total > 0 ? limits::lowest() : limits::max();
+        }
+
+        void fire(const id_type id, const count_t new_count) {
+            m_counts[id] = new_count;
+            m_thresholds[id] = detail::next_fraction_count<scale>(new_count, m_totals[id]).value_or(limits::max());
+        }
+
+        std::vector<count_t> m_counts;
+        std::vector<count_t> m_totals;
+        std::vector<count_t> m_thresholds;
+    };
+
+    template <typename count_t = std::int64_t>
+    using int_percentage_filter_bank = fraction_filter_bank<100, count_t>;
+
+    ///
+    /// Stores many filters that behave like \ref update_filter instances with the
+    /// filter_policy::basic_sampled<chrono_clock_t> policy, each tracking a single arithmetic
+    /// value and sharing one interval, in contiguous columns of last-actioned values and next due
+    /// times. Updates are reported as for \ref fraction_filter_bank. The clock is read once per
+    /// call to update(), rather than once per filter.
+    ///
+
+    template <typename chrono_clock_t, typename value_t>
+    class basic_sampled_filter_bank {
+    public:
+
+        static_assert(std::is_arithmetic_v<value_t>);
+
+        using id_type = std::size_t;
+
+        explicit basic_sampled_filter_bank(const std::chrono::milliseconds interval)
+          : m_interval{std::chrono::ceil<duration>(interval).count()} {}
+
+        auto add() -> id_type {
+            m_values.push_back(value_t{});
+            m_next_due.push_back(std::numeric_limits<rep>::lowest());
+            return m_values.size() - 1;
+        }
+
+        auto size() const noexcept -> std::size_t {
+            return m_values.size();
+        }
+
+        auto value(const id_type id) const -> value_t {
+            return m_values[id];
+        }
+
+        template <typename id_iter_t, typename value_iter_t, typename out_iter_t>
+        auto update(id_iter_t ids_first, const id_iter_t ids_last, value_iter_t values_first, out_iter_t fired)
+            -> out_iter_t {
+
+            const auto now = m_clock.now().time_since_epoch().count();
+
+            for (; ids_first != ids_last; ++ids_first, ++values_first) {
+
+                const auto id = static_cast<id_type>(*ids_first);
+                const auto new_value = static_cast<value_t>(*values_first);
+
+                if ((new_value != m_values[id]) & (now >= m_next_due[id])) {
+                    fire(id, new_value, now);
+                    *fired++ = id;
+                }
+            }
+
+            return fired;
+        }
+
+        auto update(const id_type first, const value_t* const values_first, const value_t* const values_last,
+            filter_bank_bitmap& fired) -> std::size_t {
+
+            const auto count = static_cast<std::size_t>(values_last - values_first);
+            KSR_ASSERT(first + count <= size());
+
+            const auto now = m_clock.now().time_since_epoch().count();
+            const auto last_values = m_values.data() + first;
+            const auto next_due = m_next_due.data() + first;
+
+            return detail::bank_update_dense(count, fired,
+                [&](const std::size_t begin, const std::size_t size) {
+                    auto bits = std::uint64_t{0};
+                    for (auto j = std::size_t{0}; j < size; ++j) {
+                        const auto due = (values_first[begin + j] != last_values[begin + j]) &
+                            (now >= next_due[begin + j]);
+                        bits |= static_cast<std::uint64_t>(due) << j;
+                    }
+                    return bits;
+                },
+                [&](const std::size_t index) {
+                    fire(first + index, values_first[index], now);
+                });
+        }
+
+    private:
+
+        using duration = typename chrono_clock_t::duration;
+        using rep = typename duration::rep;
+
+        void fire(const id_type id, const value_t new_value, const rep now) {
+            m_values[id] = new_value;
+            m_next_due[id] = now + m_interval;
+        }
+
+        rep m_interval;
+        chrono_clock_t m_clock;
+
+        std::vector<value_t> m_values;
+        std::vector<rep> m_next_due;
+    };
+
+    template <typename value_t>
+    using sampled_filter_bank = basic_sampled_filter_bank<std::chrono::steady_clock, value_t>;
+}
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef KSR_FILTER_STATS_HPP
+#define KSR_FILTER_STATS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef KSR_UPDATE_FILTER_STATS
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#endif
+
+///
+/// Statistics for \ref ksr::basic_update_filter are opt-in: they are only collected if
+/// \c KSR_UPDATE_FILTER_STATS is defined (consistently, for every translation unit of the
+/// program). Otherwise, ksr/update_filter.hpp doesn't include this header, the instrumentation
+/// points in the filter compile to nothing, and the filter's layout is unchanged; the enumeration
+/// functions below still exist, but find no filters.
+///
+
+namespace ksr {
+
+    ///
+    /// The statistics of one filter at the time they were read. The callback latency histogram has
+    /// logarithmic buckets: bucket \c i counts callbacks that took [2^i, 2^(i+1)) nanoseconds
+    /// (with bucket 0 also counting callbacks that took under a nanosecond, and the last bucket
+    /// also counting any that took longer).
+    ///
+
+    struct filter_stats_snapshot {
+
+        static constexpr auto latency_bucket_count = std::size_t{32};
+
+        std::uint64_t id = 0;
+        std::string name;
+        std::uint64_t calls = 0;
+        std::uint64_t accepted = 0;
+        std::uint64_t rejected = 0;
+        std::uint64_t syncs = 0;
+        std::array<std::uint64_t, latency_bucket_count> callback_latency{};
+    };
+
+    namespace detail {
+
+#ifdef KSR_UPDATE_FILTER_STATS
+
+        ///
+        /// The statistics record of a filter. Counters are kept in a few cache-line-aligned
+        /// shards, selected per thread, and are updated with relaxed atomic additions, so that
+        /// recording never locks and threads using different filters (or, for filters that are
+        /// shared, the same filter) rarely contend. Each record registers itself in a global list
+        /// on construction, from which it is removed on destruction.
+        ///
+        /// This is costly for filters that are small or short-lived: the shards take 1280 bytes
+        /// (four cache-line-aligned sets of 36 counters), and construction, copying and
+        /// destruction each lock the list's mutex, so filters created and destroyed on many
+        /// threads at once serialise there.
+        ///
+
+        class update_filter_stats {
+        public:
+
+            update_filter_stats() {
+                registry().add(this);
+            }
+
+            update_filter_stats(const update_filter_stats& rhs)
+              : m_name{rhs.name()} {
+                registry().add(this);
+            }
+
+            auto operator=(const update_filter_stats&) -> update_filter_stats& {
+                return *this;
+            }
+
+            ~update_filter_stats() {
+                registry().remove(this);
+            }
+
+            ///
+            /// Sets the name under which the filter's statistics are reported.
+            ///
+
+            void set_stats_name(const std::string_view name) {
+                const auto lock = std::lock_guard{registry().mutex};
+                m_name = name;
+            }
+
+            static void for_each(void (*fn)(const filter_stats_snapshot&, void*), void* context) {
+
+                const auto lock = std::lock_guard{registry().mutex};
+                for (const auto record : registry().records) {
+                    fn(record->snapshot(), context);
+                }
+            }
+
+        protected:
+
+            void count_update(const bool accepted) noexcept {
+                auto& counters = shard();
+                add(counters.calls);
+                add(accepted ? counters.accepted : counters.rejected);
+            }
+
+            void count_sync() noexcept {
+                add(shard().syncs);
+            }
+
+            template <typename fn_t>
+            void invoke_timed(fn_t&& fn) {
+
+                const auto start = std::chrono::steady_clock::now();
+                std::forward<fn_t>(fn)();
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+
+                const auto ns = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+                auto bucket = std::size_t{0};
+                while (bucket + 1 < filter_stats_snapshot::latency_bucket_count && ns >> (bucket + 1) != 0) {
+                    ++bucket;
+                }
+
+                add(shard().callback_latency[bucket]);
+            }
+
+        private:
+
+            static constexpr auto shard_count = std::size_t{4};
+
+            struct alignas(64) counter_shard {
+                std::atomic<std::uint64_t> calls{0};
+                std::atomic<std::uint64_t> accepted{0};
+                std::atomic<std::uint64_t> rejected{0};
+                std::atomic<std::uint64_t> syncs{0};
+                std::array<std::atomic<std::uint64_t>, filter_stats_snapshot::latency_bucket_count> callback_latency{};
+            };
+
+            struct registry_t {
+
+                void add(update_filter_stats* const record) {
+                    const auto lock = std::lock_guard{mutex};
+                    record->m_id = ++last_id;
+                    records.push_back(record);
+                }
+
+                void remove(update_filter_stats* const record) {
+                    const auto lock = std::lock_guard{mutex};
+                    for (auto& entry : records) {
+                        if (entry == record) {
+                            entry = records.back();
+                            records.pop_back();
+                            break;
+                        }
+                    }
+                }
+
+                std::mutex mutex;
+                std::vector<update_filter_stats*> records;
+                std::uint64_t last_id = 0;
+            };
+
+            // The registry is never destroyed, so that filters with static storage duration may
+            // safely unregister themselves during program termination.
+
+            static auto registry() -> registry_t& {
+                static auto& instance = *new registry_t{};
+                return instance;
+            }
+
+            static void add(std::atomic<std::uint64_t>& counter) noexcept {
+                counter.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            auto shard() noexcept -> counter_shard& {
+                static auto next_index = std::atomic<std::size_t>{0};
+                thread_local const auto index = next_index.fetch_add(1, std::memory_order_relaxed);
+                return m_shards[index % shard_count];
+            }
+
+            auto name() const -> std::string {
+                const auto lock = std::lock_guard{registry().mutex};
+                return m_name;
+            }
+
+            // Called with the registry's mutex held.
+
+            auto snapshot() const -> filter_stats_snapshot {
+
+                auto result = filter_stats_snapshot{};
+                result.id = m_id;
+                result.name = m_name;
+
+                for (const auto& counters : m_shards) {
+                    result.calls += counters.calls.load(std::memory_order_relaxed);
+                    result.accepted += counters.accepted.load(std::memory_order_relaxed);
+                    result.rejected += counters.rejected.load(std::memory_order_relaxed);
+                    result.syncs += counters.syncs.load(std::memory_order_relaxed);
+                    for (auto i = std::size_t{0}; i < result.callback_latency.size(); ++i) {
+                        result.callback_latency[i] += counters.callback_latency[i].load(std::memory_order_relaxed);
+                    }
+                }
+
+                return result;
+            }
+
+            std::array<counter_shard, shard_count> m_shards;
+            std::uint64_t m_id = 0;
+            std::string m_name;
+        };
+
+#endif
+
+        inline void write_json_string(std::ostream& out, const std::string_view str) {
+
+            out << '"';
+            for (const auto c : str) {
+                if (c == '"' || c == '\\') {
+                    out << '\\' << c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+    }
+
+    ///
+    /// Returns whether statistics are being collected (i.e. whether \c KSR_UPDATE_FILTER_STATS is
+    /// defined).
+    ///
+
+    constexpr auto filter_stats_enabled() noexcept -> bool {
+#ifdef KSR_UPDATE_FILTER_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    ///
+    /// Returns a snapshot of the statistics of every live filter, in no particular order.
+    ///
+
+    inline auto filter_stats() -> std::vector<filter_stats_snapshot> {
+
+        auto result = std::vector<filter_stats_snapshot>{};
+#ifdef KSR_UPDATE_FILTER_STATS
+        detail::update_filter_stats::for_each([](const filter_stats_snapshot& snapshot, void* const context) {
+            static_cast<std::vector<filter_stats_snapshot>*>(context)->push_back(snapshot);
+        }, &result);
+#endif
+
+        return result;
+    }
+
+    ///
+    /// Writes the statistics of every live filter to \p out as a JSON array of objects, ordered
+    /// by filter id (i.e. by order of construction).
+    ///
+
+    inline void dump_filter_stats_json(std::ostream& out) {
+
+        auto snapshots = filter_stats();
+        std::sort(snapshots.begin(), snapshots.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.id < rhs.id;
+        });
+
+        out << '[';
+        for (auto i = std::size_t{0}; i < snapshots.size(); ++i) {
+
+            const auto& snapshot = snapshots[i];
+            out << (i > 0 ? ",\n " : "\n ") << "{\"id\": " << snapshot.id << ", \"name\": ";
+            detail::write_json_string(out, snapshot.name);
+            out << ", \"calls\": " << snapshot.calls
+                << ", \"accepted\": " << snapshot.accepted
+                << ", \"rejected\": " << snapshot.rejected
+                << ", \"syncs\": " << snapshot.syncs
+                << ", \"callback_latency_log2_ns\": [";
+
+            for (auto bucket = std::size_t{0}; bucket < snapshot.callback_latency.size(); ++bucket) {
+                out << (bucket > 0 ? ", " : "") << snapshot.callback_latency[bucket];
+            }
+
+            out << "]}";
+        }
+        out << (snapshots.empty() ? "]" : "\n]");
+    }
+}
+
+#endif
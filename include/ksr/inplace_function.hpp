@@ -0,0 +1,152 @@
+#ifndef KSR_INPLACE_FUNCTION_HPP
+#define KSR_INPLACE_FUNCTION_HPP
+
+#include "type_traits.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ksr {
+
+    inline constexpr auto inplace_function_default_capacity = std::size_t{4 * sizeof(void*)};
+
+    ///
+    /// A type-erased, owning wrapper for callable objects, in the manner of \c std::function, that
+    /// stores the target object in a fixed-capacity buffer embedded in the \ref inplace_function
+    /// itself. No \ref inplace_function operation ever allocates: attempting to construct one from
+    /// a function object that does not fit within \p capacity bytes (or that requires stricter
+    /// alignment than \c std::max_align_t, or that cannot be moved without throwing) is a
+    /// compile-time error rather than a fallback to the heap.
+    ///
+    /// Invoking an empty \ref inplace_function is undefined behaviour (unlike \c std::function,
+    /// which throws \c std::bad_function_call); emptiness may be tested via <tt>operator bool</tt>.
+    ///
+
+    template <typename, std::size_t capacity = inplace_function_default_capacity>
+    class inplace_function;
+
+    template <typename ret_t, typename... arg_ts, std::size_t capacity>
+    class inplace_function<ret_t(arg_ts...), capacity> {
+    public:
+
+        inplace_function() noexcept = default;
+
+        template <
+            typename function_t,
+            typename = std::enable_if_t<!matches_special_ctr_v<inplace_function, function_t>>
+        >
+        inplace_function(function_t&& function) {
+
+            using target_t = std::decay_t<function_t>;
+            static_assert(sizeof(target_t) <= capacity,
+                "function object is too large for the inplace_function buffer");
+            static_assert(alignof(target_t) <= alignof(std::max_align_t),
+                "function object is over-aligned for the inplace_function buffer");
+            static_assert(std::is_nothrow_move_constructible_v<target_t>,
+                "function object must be nothrow move-constructible");
+
+            ::new (static_cast<void*>(&m_storage)) target_t(std::forward<function_t>(function));
+            m_ops = &ops_for<target_t>;
+        }
+
+        inplace_function(const inplace_function& rhs)
+          : m_ops{rhs.m_ops} {
+
+            if (m_ops) {
+                m_ops->copy(&m_storage, &rhs.m_storage);
+            }
+        }
+
+        inplace_function(inplace_function&& rhs) noexcept
+          : m_ops{rhs.m_ops} {
+
+            if (m_ops) {
+                m_ops->move(&m_storage, &rhs.m_storage);
+                rhs.m_ops = nullptr;
+            }
+        }
+
+        auto operator=(const inplace_function& rhs) -> inplace_function& {
+
+            if (this != &rhs) {
+                auto temp = rhs;
+                *this = std::move(temp);
+            }
+            return *this;
+        }
+
+        auto operator=(inplace_function&& rhs) noexcept -> inplace_function& {
+
+            if (this != &rhs) {
+                reset();
+                if (rhs.m_ops) {
+                    rhs.m_ops->move(&m_storage, &rhs.m_storage);
+                    m_ops = std::exchange(rhs.m_ops, nullptr);
+                }
+            }
+            return *this;
+        }
+
+        ~inplace_function() {
+            reset();
+        }
+
+        explicit operator bool() const noexcept {
+            return m_ops != nullptr;
+        }
+
+        ret_t operator()(arg_ts... args) const {
+            return m_ops->invoke(&m_storage, std::forward<arg_ts>(args)...);
+        }
+
+    private:
+
+        using storage_t = std::aligned_storage_t<capacity, alignof(std::max_align_t)>;
+
+        // A single static table of operations per target type keeps each inplace_function instance
+        // to one pointer of overhead beyond its buffer, and means that the call operator pays for
+        // exactly one indirect call (as for std::function, but without the allocation). As with
+        // std::function, the target is invoked as non-const even through a const wrapper, hence
+        // the mutable buffer.
+
+        struct ops {
+            ret_t (*invoke)(void*, arg_ts&&...);
+            void (*copy)(void*, const void*);
+            void (*move)(void*, void*) noexcept;
+            void (*destroy)(void*) noexcept;
+        };
+
+        template <typename t>
+        static constexpr auto ops_for = ops{
+            [](void* target, arg_ts&&... args) -> ret_t {
+                return std::invoke(*static_cast<t*>(target), std::forward<arg_ts>(args)...);
+            },
+            [](void* dest, const void* src) {
+                ::new (dest) t(*static_cast<const t*>(src));
+            },
+            [](void* dest, void* src) noexcept {
+                ::new (dest) t(std::move(*static_cast<t*>(src)));
+                static_cast<t*>(src)->~t();
+            },
+            [](void* target) noexcept {
+                static_cast<t*>(target)->~t();
+            }
+        };
+
+        void reset() noexcept {
+
+            if (m_ops) {
+                m_ops->destroy(&m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+        const ops* m_ops = nullptr;
+        mutable storage_t m_storage;
+    };
+}
+
+#endif
@@ -7,13 +7,22 @@
 
 namespace ksr {
 
-    template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
-    auto int_percentage(const num_t num, const num_t denom) -> int {
+    /// Computes the quotient `num / denom` scaled by `scale` and rounded to the nearest integer
+    /// (for example, in per-mille when `scale` is 1000). `denom` must be nonzero.
+
+    template <int scale, typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
+    auto int_fraction(const num_t num, const num_t denom) -> int {
 
         KSR_ASSERT(denom != num_t{});
-        const auto result = std::lround(100.0 * static_cast<double>(num) / static_cast<double>(denom));
+        const auto result = std::lround(
+            static_cast<double>(scale) * static_cast<double>(num) / static_cast<double>(denom));
         return narrow_cast<int>(result);
     }
+
+    template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
+    auto int_percentage(const num_t num, const num_t denom) -> int {
+        return int_fraction<100>(num, denom);
+    }
 }
 
 #endif
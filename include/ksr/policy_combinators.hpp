@@ -0,0 +1,370 @@
+#ifndef KSR_POLICY_COMBINATORS_HPP
+#define KSR_POLICY_COMBINATORS_HPP
+
+#include "update_filter.hpp"
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ksr {
+
+    namespace detail {
+
+        inline constexpr auto default_evaluation_cost = 5;
+
+        ///
+        /// The relative cost of a policy's can_update(), as declared by its public static
+        /// \c evaluation_cost member, or a middling default for policies that don't declare one.
+        /// By convention, a single integer comparison costs 1 and a clock read 10.
+        ///
+
+        template <typename policy_t>
+        constexpr auto evaluation_cost(int) -> decltype(int{policy_t::evaluation_cost}) {
+            return policy_t::evaluation_cost;
+        }
+
+        template <typename policy_t>
+        constexpr auto evaluation_cost(...) -> int {
+            return default_evaluation_cost;
+        }
+
+        ///
+        /// The indices of \p policy_ts sorted by ascending evaluation cost (stably, so that
+        /// policies of equal cost are evaluated in the order given).
+        ///
+
+        template <typename... policy_ts>
+        constexpr auto cheapest_first() -> std::array<std::size_t, sizeof...(policy_ts)> {
+
+            constexpr auto costs = std::array<int, sizeof...(policy_ts)>{evaluation_cost<policy_ts>(int{})...};
+
+            auto order = std::array<std::size_t, sizeof...(policy_ts)>{};
+            for (auto i = std::size_t{0}; i < order.size(); ++i) {
+                auto j = i;
+                for (; j > 0 && costs[order[j - 1]] > costs[i]; --j) {
+                    order[j] = order[j - 1];
+                }
+                order[j] = i;
+            }
+
+            return order;
+        }
+
+        template <typename... policy_ts, std::size_t... is>
+        constexpr auto cheapest_first_sequence(std::index_sequence<is...>)
+            -> std::index_sequence<cheapest_first<policy_ts...>()[is]...> { return {}; }
+
+        struct default_policy_data {};
+
+        ///
+        /// Whether a policy declares, by a public static \c accesses_filter_state member, that its
+        /// public accessors downcast to the filter state of the policy itself (as
+        /// filter_policy::int_fraction's count() and total() do).
+        ///
+
+        template <typename policy_t>
+        constexpr auto accesses_filter_state(int) -> decltype(bool{policy_t::accesses_filter_state}) {
+            return policy_t::accesses_filter_state;
+        }
+
+        template <typename policy_t>
+        constexpr auto accesses_filter_state(...) -> bool {
+            return false;
+        }
+
+        ///
+        /// The base of a \ref policy_element: the policy itself, or for a policy whose count() and
+        /// total() downcast to its filter state (which, within a combinator, isn't the object's
+        /// actual type), the policy with those accessors hidden, so that calling them fails to
+        /// compile. Other policies' accessors remain visible.
+        ///
+
+        template <typename policy_t, bool = accesses_filter_state<policy_t>(int{})>
+        class policy_accessors : public policy_t {
+        protected:
+            using policy_t::policy_t;
+        };
+
+        template <typename policy_t>
+        class policy_accessors<policy_t, true> : public policy_t {
+        public:
+
+            void count() const = delete;
+            void total() const = delete;
+
+        protected:
+            using policy_t::policy_t;
+        };
+
+        ///
+        /// Holds the policy at position \p index of a combinator as a distinct base class, so that
+        /// the same policy may appear more than once, including within nested combinators (which
+        /// are told apart by \p set_t, the list of policies that they combine).
+        ///
+
+        template <typename set_t, std::size_t index, typename policy_t>
+        class policy_element : public policy_accessors<policy_t> {
+        protected:
+
+            explicit policy_element(default_policy_data) {}
+
+            template <typename t>
+            explicit policy_element(const t& policy_data)
+              : policy_accessors<policy_t>{policy_data} {}
+        };
+
+        ///
+        /// The common base of the combinators: constructs each policy from its share of the
+        /// policy data, and forwards on_update() to every policy that provides it. The policy
+        /// data are a tuple with one element for each policy that is not default-constructible,
+        /// in order; if there is only one such policy, its data may also be given directly.
+        ///
+
+        template <typename index_seq, typename... policy_ts>
+        class policy_set;
+
+        template <std::size_t... is, typename... policy_ts>
+        class policy_set<std::index_sequence<is...>, policy_ts...> : public policy_element<std::tuple<policy_ts...>, is, policy_ts>... {
+        protected:
+
+            static constexpr auto needs_data = std::array<bool, sizeof...(policy_ts)>{
+                !std::is_default_constructible_v<policy_ts>...};
+            static constexpr auto data_count = (std::size_t{0} + ... + static_cast<std::size_t>(needs_data[is]));
+
+            template <std::size_t index>
+            using element = policy_element<std::tuple<policy_ts...>, index, std::tuple_element_t<index, std::tuple<policy_ts...>>>;
+
+            // A template, so that (via the combinator's implicit default constructor) the combined
+            // policy is only default-constructible when all of its constituents are.
+
+            template <std::size_t count = data_count, typename = std::enable_if_t<count == 0>>
+            policy_set()
+              : policy_element<std::tuple<policy_ts...>, is, policy_ts>{default_policy_data{}}... {}
+
+            template <typename... data_ts>
+            explicit policy_set(const std::tuple<data_ts...>& policy_data)
+              : policy_element<std::tuple<policy_ts...>, is, policy_ts>{data_for<is>(policy_data)}... {
+                static_assert(sizeof...(data_ts) == data_count, "one datum is needed per non-default-constructible policy");
+            }
+
+            template <typename t, std::size_t count = data_count, typename = std::enable_if_t<count == 1>>
+            explicit policy_set(const t& policy_data)
+              : policy_set{std::tie(policy_data)} {}
+
+            template <typename... value_ts>
+            void on_update(const std::tuple<value_ts...>& values) {
+                (notify<is>(values, int{}), ...);
+            }
+
+            // Forwards on_reject() to every policy that provides it. A combinator calls this
+            // (through decide()) whenever its combined decision is to reject an update, which any
+            // of its policies may nonetheless have accepted, so that none of them retains state
+            // from a decision that didn't take effect.
+
+            void on_reject() const {
+                (notify_reject<is>(int{}), ...);
+            }
+
+            auto decide(const bool accepted) const -> bool {
+                if (!accepted) {
+                    on_reject();
+                }
+                return accepted;
+            }
+
+        private:
+
+            template <std::size_t index, typename data_tuple_t>
+            static constexpr decltype(auto) data_for(const data_tuple_t& policy_data) {
+
+                if constexpr (needs_data[index]) {
+                    constexpr auto data_index = [] {
+                        auto result = std::size_t{0};
+                        for (auto i = std::size_t{0}; i < index; ++i) {
+                            result += needs_data[i];
+                        }
+                        return result;
+                    }();
+                    return std::get<data_index>(policy_data);
+                } else {
+                    return default_policy_data{};
+                }
+            }
+
+            // As in update_filter_state, detection of the (typically protected) on_update() has
+            // to take place within the scope of a derived class.
+
+            template <std::size_t index, typename values_t>
+            auto notify(const values_t& values, int) -> decltype(this->element<index>::on_update(values)) {
+                this->element<index>::on_update(values);
+            }
+
+            template <std::size_t index, typename values_t>
+            void notify(const values_t&, ...) {}
+
+            template <std::size_t index>
+            auto notify_reject(int) const -> decltype(this->element<index>::on_reject()) {
+                this->element<index>::on_reject();
+            }
+
+            template <std::size_t index>
+            void notify_reject(...) const {}
+        };
+    }
+
+    namespace filter_policy {
+
+        ///
+        /// Policy combinator for an \ref update_filter that accepts an update only when all of
+        /// \p policies accept it. The policies are evaluated cheapest first (as per their
+        /// \c evaluation_cost), stopping at the first that rejects the update, so that, for
+        /// example, an int_percentage threshold comparison rejects most updates before sampled
+        /// ever reads the clock. Each policy's on_update() is called whenever the combined policy
+        /// accepts an update (or on sync()), whether or not that policy was evaluated; likewise,
+        /// its on_reject(), if it has one, whenever the combined policy rejects an update.
+        ///
+        /// The combined policy can be used wherever its constituent policies can:
+        /// ```c++
+        /// using percent_and_50ms = filter_policy::all_of<filter_policy::int_percentage,
+        ///     filter_policy::sampled>;
+        /// auto filter = update_filter<percent_and_50ms::policy, int, int>{50ms, callback};
+        /// ```
+        /// Policies that need construction data receive them in order from a tuple passed as the
+        /// filter's policy data (or directly, if only one policy needs data).
+        ///
+        /// Policies are combined by inheritance, so the combined policy is exactly as large as its
+        /// constituents, and the whole evaluation is visible to the compiler; a combination costs
+        /// no more than the equivalent hand-written policy.
+        ///
+
+        template <template <typename...> class... policies>
+        struct all_of {
+
+            static_assert(sizeof...(policies) > 0);
+
+            template <typename... value_ts>
+            class policy : public detail::policy_set<
+                std::index_sequence_for<policies<value_ts...>...>, policies<value_ts...>...> {
+            private:
+
+                using base_t = detail::policy_set<
+                    std::index_sequence_for<policies<value_ts...>...>, policies<value_ts...>...>;
+
+            public:
+
+                static constexpr auto evaluation_cost =
+                    (0 + ... + detail::evaluation_cost<policies<value_ts...>>(int{}));
+
+            protected:
+
+                using base_t::base_t;
+
+                auto can_update(
+                    const std::tuple<value_ts...>& current_values,
+                    const std::tuple<const value_ts&...>& new_values) const -> bool {
+
+                    return evaluate(current_values, new_values,
+                        detail::cheapest_first_sequence<policies<value_ts...>...>(
+                            std::index_sequence_for<policies<value_ts...>...>{}));
+                }
+
+            private:
+
+                template <std::size_t... order>
+                auto evaluate(
+                    const std::tuple<value_ts...>& current_values,
+                    const std::tuple<const value_ts&...>& new_values,
+                    std::index_sequence<order...>) const -> bool {
+
+                    return this->decide((this->template element<order>::can_update(current_values, new_values) && ...));
+                }
+            };
+        };
+
+        ///
+        /// Policy combinator for an \ref update_filter that accepts an update when any of
+        /// \p policies accepts it, evaluating them cheapest first and stopping at the first that
+        /// accepts it. Otherwise as for \ref all_of.
+        ///
+
+        template <template <typename...> class... policies>
+        struct any_of {
+
+            static_assert(sizeof...(policies) > 0);
+
+            template <typename... value_ts>
+            class policy : public detail::policy_set<
+                std::index_sequence_for<policies<value_ts...>...>, policies<value_ts...>...> {
+            private:
+
+                using base_t = detail::policy_set<
+                    std::index_sequence_for<policies<value_ts...>...>, policies<value_ts...>...>;
+
+            public:
+
+                static constexpr auto evaluation_cost =
+                    (0 + ... + detail::evaluation_cost<policies<value_ts...>>(int{}));
+
+            protected:
+
+                using base_t::base_t;
+
+                auto can_update(
+                    const std::tuple<value_ts...>& current_values,
+                    const std::tuple<const value_ts&...>& new_values) const -> bool {
+
+                    return evaluate(current_values, new_values,
+                        detail::cheapest_first_sequence<policies<value_ts...>...>(
+                            std::index_sequence_for<policies<value_ts...>...>{}));
+                }
+
+            private:
+
+                template <std::size_t... order>
+                auto evaluate(
+                    const std::tuple<value_ts...>& current_values,
+                    const std::tuple<const value_ts&...>& new_values,
+                    std::index_sequence<order...>) const -> bool {
+
+                    return this->decide((this->template element<order>::can_update(current_values, new_values) || ...));
+                }
+            };
+        };
+
+        ///
+        /// Policy combinator for an \ref update_filter that accepts exactly the updates that
+        /// \p inner_policy rejects. Mostly useful within \ref all_of and \ref any_of.
+        ///
+
+        template <template <typename...> class inner_policy>
+        struct not_ {
+
+            template <typename... value_ts>
+            class policy : public detail::policy_set<std::index_sequence<0>, inner_policy<value_ts...>> {
+            private:
+
+                using base_t = detail::policy_set<std::index_sequence<0>, inner_policy<value_ts...>>;
+
+            public:
+
+                static constexpr auto evaluation_cost = detail::evaluation_cost<inner_policy<value_ts...>>(int{});
+
+            protected:
+
+                using base_t::base_t;
+
+                auto can_update(
+                    const std::tuple<value_ts...>& current_values,
+                    const std::tuple<const value_ts&...>& new_values) const -> bool {
+
+                    return this->decide(!this->template element<0>::can_update(current_values, new_values));
+                }
+            };
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef KSR_POLLED_FILTER_HPP
+#define KSR_POLLED_FILTER_HPP
+
+#include "error.hpp"
+#include "inplace_function.hpp"
+#include "update_filter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ksr {
+
+    namespace detail {
+
+        // Each slot occupies a cache line of its own, so that a worker writing one slot doesn't
+        // contend with workers writing others, nor with the sampler reading them.
+
+        template <typename t>
+        struct alignas(64) polled_slot {
+            std::atomic<t> value{};
+        };
+    }
+
+    ///
+    /// A counterpart of \ref basic_update_filter that moves filtering off the producer's thread
+    /// entirely. Instead of calling update(), workers write the current data into atomic slots
+    /// (one per element of \p value_ts) via store() or add(), which compile to single relaxed
+    /// atomic operations with no branch or policy call; the data are then fed through an ordinary
+    /// \ref basic_update_filter (with the same \p policy and \p callback_t) whenever poll() is
+    /// called, typically by a \ref poll_sampler at a fixed cadence. The per-item cost to workers
+    /// is therefore independent of the policy, at the expense of updates being noticed up to one
+    /// polling interval late.
+    ///
+    /// Each type in \p value_ts must be trivially copyable, so that it can be held in a
+    /// \c std::atomic. As the slots are read one at a time, a poll may observe a mixture of
+    /// old and new values written concurrently to different slots.
+    ///
+    /// store() and add() may be called from any number of threads. poll() and sync() may also be
+    /// called from any thread, and are serialised with each other; the callback is invoked on the
+    /// thread calling them.
+    ///
+
+    template <template <typename...> class policy, typename callback_t, typename... value_ts>
+    class basic_polled_filter {
+    public:
+
+        template <std::size_t index>
+        friend auto adl_get(const basic_polled_filter& self) {
+            const auto lock = std::lock_guard{self.m_mutex};
+            return ksr::get<index>(self.m_filter);
+        }
+
+        explicit basic_polled_filter(callback_t update)
+          : m_filter{std::move(update)} {}
+
+        template <typename t>
+        explicit basic_polled_filter(const t& policy_data, callback_t update)
+          : m_filter{policy_data, std::move(update)} {}
+
+        basic_polled_filter(const basic_polled_filter&) = delete;
+        auto operator=(const basic_polled_filter&) -> basic_polled_filter& = delete;
+
+        ///
+        /// Sets the slot for element \p index of the data to \p value.
+        ///
+
+        template <std::size_t index>
+        void store(const std::tuple_element_t<index, std::tuple<value_ts...>> value) noexcept {
+            std::get<index>(m_slots).value.store(value, std::memory_order_relaxed);
+        }
+
+        ///
+        /// Adds \p delta to the slot for element \p index of the data, which must be of integral
+        /// type. Several threads may add to the same slot (e.g. a shared item count), although
+        /// they then contend for its cache line.
+        ///
+
+        template <std::size_t index>
+        void add(const std::tuple_element_t<index, std::tuple<value_ts...>> delta) noexcept {
+            std::get<index>(m_slots).value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        ///
+        /// Reads the slots and passes their values to the filter's update(), returning \c true if
+        /// the policy accepted them (and the callback was therefore invoked).
+        ///
+
+        auto poll() -> bool {
+            const auto lock = std::lock_guard{m_mutex};
+            return std::apply([this](const auto&... slots) {
+                return m_filter.update(slots.value.load(std::memory_order_relaxed)...);
+            }, m_slots);
+        }
+
+        ///
+        /// Reads the slots and passes their values to the filter's sync(), invoking the callback
+        /// unconditionally; typically called once the workers have finished.
+        ///
+
+        void sync() {
+            const auto lock = std::lock_guard{m_mutex};
+            std::apply([this](const auto&... slots) {
+                m_filter.sync(slots.value.load(std::memory_order_relaxed)...);
+            }, m_slots);
+        }
+
+    private:
+
+        static_assert(std::conjunction_v<std::is_trivially_copyable<value_ts>...>,
+            "polled_filter values must be trivially copyable");
+
+        std::tuple<detail::polled_slot<value_ts>...> m_slots;
+
+        mutable std::mutex m_mutex;
+        basic_update_filter<policy, callback_t, value_ts...> m_filter;
+    };
+
+    template <template <typename...> class policy, typename... value_ts>
+    using polled_filter = basic_polled_filter<policy, std::function<void(value_ts...)>, value_ts...>;
+
+    ///
+    /// A thread that calls a set of poll functions (such as the poll() members of
+    /// \ref basic_polled_filter instances) once per interval, so that any number of polled
+    /// filters can share one sampling thread. Poll functions run one at a time, in the order they
+    /// were attached, and should be brief.
+    ///
+
+    class poll_sampler {
+    public:
+
+        using clock = std::chrono::steady_clock;
+        using task = inplace_function<void()>;
+        using poll_id = std::uint64_t;
+
+        explicit poll_sampler(const clock::duration interval)
+          : m_interval{interval} {
+
+            KSR_ASSERT(interval > clock::duration::zero());
+            m_thread = std::thread{[this] { run(); }};
+        }
+
+        poll_sampler(const poll_sampler&) = delete;
+        auto operator=(const poll_sampler&) -> poll_sampler& = delete;
+
+        ~poll_sampler() {
+
+            {
+                const auto lock = std::lock_guard{m_mutex};
+                m_stopping = true;
+            }
+
+            m_wake.notify_all();
+            m_thread.join();
+        }
+
+        ///
+        /// Adds \p fn to the functions called on each tick, returning an identifier that may be
+        /// passed to detach().
+        ///
+
+        auto attach(task fn) -> poll_id {
+            const auto lock = std::lock_guard{m_mutex};
+            const auto id = ++m_next_id;
+            m_polls.push_back(entry{id, std::move(fn)});
+            return id;
+        }
+
+        template <template <typename...> class policy, typename callback_t, typename... value_ts>
+        auto attach(basic_polled_filter<policy, callback_t, value_ts...>& filter) -> poll_id {
+            return attach([&filter] { filter.poll(); });
+        }
+
+        ///
+        /// Removes the function identified by \p id. As poll functions are called with the
+        /// sampler's mutex held, this waits for any poll in progress (unless called from a poll
+        /// function, which is not permitted), so on return the function is no longer running.
+        ///
+
+        void detach(const poll_id id) {
+            const auto lock = std::lock_guard{m_mutex};
+            m_polls.erase(std::remove_if(m_polls.begin(), m_polls.end(),
+                [id](const entry& item) { return item.id == id; }), m_polls.end());
+        }
+
+    private:
+
+        struct entry {
+            poll_id id;
+            task fn;
+        };
+
+        void run() {
+
+            auto lock = std::unique_lock{m_mutex};
+            auto next_tick = clock::now() + m_interval;
+
+            while (!m_wake.wait_until(lock, next_tick, [this] { return m_stopping; })) {
+
+                for (const auto& item : m_polls) {
+                    item.fn();
+                }
+
+                // Ticks missed while polling (or while the thread was descheduled) are skipped
+                // rather than made up in a burst.
+
+                next_tick = std::max(next_tick + m_interval, clock::now());
+            }
+        }
+
+        clock::duration m_interval;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::vector<entry> m_polls;
+        poll_id m_next_id = 0;
+        bool m_stopping = false;
+
+        std::thread m_thread;
+    };
+}
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmismatched-tags"
+#endif
+
+namespace std {
+
+    template <std::size_t index, template <typename...> class policy, typename callback_t, typename... value_ts>
+    struct tuple_element<index, ksr::basic_polled_filter<policy, callback_t, value_ts...>> {
+        using type = std::tuple_element_t<index, std::tuple<value_ts...>>;
+    };
+
+    template <template <typename...> class policy, typename callback_t, typename... value_ts>
+    struct tuple_size<ksr::basic_polled_filter<policy, callback_t, value_ts...>>
+        : public std::integral_constant<std::size_t, sizeof...(value_ts)> {};
+}
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#endif
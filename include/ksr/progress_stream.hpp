@@ -0,0 +1,197 @@
+#ifndef KSR_PROGRESS_STREAM_HPP
+#define KSR_PROGRESS_STREAM_HPP
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define KSR_HAS_PROGRESS_STREAM
+#endif
+
+#ifdef KSR_HAS_PROGRESS_STREAM
+
+#include "dispatch_queue.hpp"
+
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+namespace ksr {
+
+    ///
+    /// An asynchronous stream of the updates accepted by a \ref basic_update_filter, which a
+    /// consumer coroutine reads by awaiting next(), rather than having a callback run on the
+    /// producer's thread. Only available (as indicated by \c KSR_HAS_PROGRESS_STREAM) when
+    /// compiling with C++20 coroutine support.
+    ///
+    /// The filter is constructed with the stream's sink() as its callback:
+    /// ```c++
+    /// auto stream = progress_stream<int, int>{ui_queue};
+    /// auto filter = basic_update_filter{
+    ///     update_filter_tag<filter_policy::int_percentage, int, int>{}, stream.sink()};
+    ///
+    /// // In a coroutine on the UI thread:
+    /// while (const auto update = co_await stream.next()) {
+    ///     const auto& [count, total] = *update;
+    ///     ...
+    /// }
+    /// ```
+    /// Backpressure coalesces: the stream holds only the latest values published, which
+    /// overwrite any that the consumer has not yet taken, so a slow consumer never stalls the
+    /// producer and always sees the most recent state. The producer calls close() when done
+    /// (typically after a final sync() of the filter); once the consumer has taken the values
+    /// published before that, next() yields an empty optional.
+    ///
+    /// If constructed with a \ref dispatch_queue, a consumer suspended in next() is resumed by
+    /// that queue (i.e. on the thread that drains it), through a node embedded in the stream, so
+    /// resumption costs no allocation; otherwise it is resumed directly on the producer's thread.
+    ///
+    /// The stream supports one consumer, awaiting one next() at a time, and any number of
+    /// producers (whose publications are serialised by a mutex, which is only taken for updates
+    /// that the filter accepts). It must outlive both the filter and any suspended consumer.
+    ///
+
+    template <typename... value_ts>
+    class progress_stream : private dispatch_queue::node {
+    public:
+
+        using value_type = std::tuple<value_ts...>;
+
+        ///
+        /// The callback through which a filter publishes to the stream.
+        ///
+
+        class sink_type {
+        public:
+
+            void operator()(const value_ts&... values) const {
+                m_stream->publish(values...);
+            }
+
+        private:
+
+            friend class progress_stream;
+
+            explicit sink_type(progress_stream& stream) noexcept
+              : m_stream{&stream} {}
+
+            progress_stream* m_stream;
+        };
+
+        ///
+        /// The awaitable returned by next(), which yields the latest values published, or an
+        /// empty optional once the stream has been closed and drained.
+        ///
+
+        class next_awaiter {
+        public:
+
+            auto await_ready() const -> bool {
+                const auto lock = std::lock_guard{m_stream->m_mutex};
+                return m_stream->ready();
+            }
+
+            auto await_suspend(const std::coroutine_handle<> consumer) -> bool {
+
+                // Values may have been published since await_ready(), in which case the consumer
+                // carries on without suspending.
+
+                const auto lock = std::lock_guard{m_stream->m_mutex};
+                if (m_stream->ready()) {
+                    return false;
+                }
+
+                m_stream->m_consumer = consumer;
+                return true;
+            }
+
+            auto await_resume() -> std::optional<value_type> {
+                const auto lock = std::lock_guard{m_stream->m_mutex};
+                return std::exchange(m_stream->m_latest, std::nullopt);
+            }
+
+        private:
+
+            friend class progress_stream;
+
+            explicit next_awaiter(progress_stream& stream) noexcept
+              : m_stream{&stream} {}
+
+            progress_stream* m_stream;
+        };
+
+        progress_stream() noexcept
+          : dispatch_queue::node{&run} {}
+
+        explicit progress_stream(dispatch_queue& resume_queue) noexcept
+          : dispatch_queue::node{&run}, m_resume_queue{&resume_queue} {}
+
+        progress_stream(const progress_stream&) = delete;
+        auto operator=(const progress_stream&) -> progress_stream& = delete;
+
+        auto sink() noexcept -> sink_type {
+            return sink_type{*this};
+        }
+
+        auto next() noexcept -> next_awaiter {
+            return next_awaiter{*this};
+        }
+
+        void publish(const value_ts&... values) {
+
+            auto lock = std::unique_lock{m_mutex};
+            m_latest.emplace(values...);
+            wake(lock);
+        }
+
+        void close() {
+
+            auto lock = std::unique_lock{m_mutex};
+            m_closed = true;
+            wake(lock);
+        }
+
+    private:
+
+        static void run(dispatch_queue::node& item) {
+            static_cast<progress_stream&>(item).m_resuming.resume();
+        }
+
+        // Called with the mutex held.
+
+        auto ready() const noexcept -> bool {
+            return m_latest.has_value() || m_closed;
+        }
+
+        // A consumer is only registered while suspended, and is cleared here before being
+        // resumed, so the embedded node is never posted again before it has run.
+
+        void wake(std::unique_lock<std::mutex>& lock) {
+
+            const auto consumer = std::exchange(m_consumer, nullptr);
+            lock.unlock();
+
+            if (!consumer) {
+                return;
+            }
+
+            if (m_resume_queue) {
+                m_resuming = consumer;
+                m_resume_queue->post(*this);
+            } else {
+                consumer.resume();
+            }
+        }
+
+        dispatch_queue* m_resume_queue = nullptr;
+
+        std::mutex m_mutex;
+        std::optional<value_type> m_latest;
+        bool m_closed = false;
+        std::coroutine_handle<> m_consumer;
+        std::coroutine_handle<> m_resuming;
+    };
+}
+
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef KSR_PROGRESS_TREE_HPP
+#define KSR_PROGRESS_TREE_HPP
+
+#include "error.hpp"
+#include "update_filter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ksr {
+
+    namespace detail {
+
+        ///
+        /// The quotient and remainder of <tt>a * b / c</tt>, for <tt>a <= c</tt> and
+        /// <tt>0 < c <= INT64_MAX</tt>, computed without overflow by long multiplication over
+        /// the bits of \p b (of which a \ref progress_tree's progress values have few), keeping
+        /// the partial product reduced modulo \p c.
+        ///
+
+        inline auto progress_mul_div(const std::uint64_t a, const std::uint64_t b, const std::uint64_t c)
+            -> std::pair<std::uint64_t, std::uint64_t> {
+
+            auto quotient = std::uint64_t{0};
+            auto remainder = std::uint64_t{0};
+
+            const auto reduce = [&] {
+                if (remainder >= c) {
+                    remainder -= c;
+                    ++quotient;
+                }
+            };
+
+            auto bit = 64;
+            while (bit > 0 && b >> (bit - 1) == 0) {
+                --bit;
+            }
+
+            // As the remainder is below c, and a at most c, neither doubling the remainder nor
+            // adding a to it can exceed 2 * INT64_MAX.
+
+            while (bit-- > 0) {
+                quotient *= 2;
+                remainder *= 2;
+                reduce();
+                if (b >> bit & 1) {
+                    remainder += a;
+                    reduce();
+                }
+            }
+
+            return {quotient, remainder};
+        }
+    }
+
+    ///
+    /// Aggregates the progress of a job that is divided hierarchically into parts (e.g. a scan
+    /// divided into directories, then files, then processing stages), each possibly running on
+    /// its own worker thread, into a single overall progress notification.
+    ///
+    /// The tree consists of groups, whose progress is the weighted mean of their children's, and
+    /// leaves, which count completed units of work towards a total. The root is a group. Workers
+    /// report progress through \ref progress_tree::leaf handles, whose increments are relaxed
+    /// atomic additions to a counter on a cache line of their own: they never lock, and (provided
+    /// that a leaf has at least as many shards as threads reporting to it) never write to a cache
+    /// line written by another thread. Progress is only aggregated when refresh() is called (e.g.
+    /// from a UI timer), which reads every leaf and passes the overall progress, in units of
+    /// \ref progress_tree::resolution, to an \ref int_percentage_filter; the callback is
+    /// therefore only invoked when the overall percentage changes.
+    ///
+    /// Nodes may be added while workers are reporting progress (as parts of the job are
+    /// discovered), but not removed; leaf handles remain valid for the lifetime of the tree.
+    ///
+
+    class progress_tree {
+    public:
+
+        using callback_t = std::function<void(std::int64_t, std::int64_t)>;
+        using node_id = std::size_t;
+
+        static constexpr auto root = node_id{0};
+        static constexpr auto resolution = std::int64_t{1'000'000};
+
+        class leaf;
+
+        explicit progress_tree(callback_t update)
+          : m_filter{std::move(update)} {
+            m_nodes.push_back(std::make_unique<node>(1, 0));
+        }
+
+        progress_tree(const progress_tree&) = delete;
+        auto operator=(const progress_tree&) -> progress_tree& = delete;
+
+        ///
+        /// Adds a group as a child of \p parent (which must itself be a group), contributing to
+        /// its parent's progress in proportion to \p weight.
+        ///
+
+        auto add_group(const node_id parent, const std::int64_t weight) -> node_id {
+            const auto lock = std::lock_guard{m_mutex};
+            return add_node(parent, weight, 0);
+        }
+
+        ///
+        /// Adds a leaf as a child of \p parent (which must be a group), contributing to its
+        /// parent's progress in proportion to \p weight, and complete when \p total units of work
+        /// have been reported. Increments from up to \p shard_count threads are kept on separate
+        /// cache lines; a leaf reported to by a single worker needs only one shard.
+        ///
+
+        auto add_leaf(
+            const node_id parent, const std::int64_t weight, const std::int64_t total,
+            const std::size_t shard_count = 1) -> leaf;
+
+        ///
+        /// Returns the progress of the node \p id, in units of \ref resolution.
+        ///
+
+        auto progress(const node_id id) const -> std::int64_t {
+            const auto lock = std::lock_guard{m_mutex};
+            return node_progress(id);
+        }
+
+        ///
+        /// Aggregates the progress of all leaves and passes it to the root filter, returning
+        /// \c true if the callback was invoked (i.e. if the overall percentage has changed).
+        ///
+
+        auto refresh() -> bool {
+            const auto lock = std::lock_guard{m_mutex};
+            return m_filter.update(node_progress(root), resolution);
+        }
+
+        ///
+        /// Aggregates the progress of all leaves and invokes the callback unconditionally.
+        ///
+
+        void sync() {
+            const auto lock = std::lock_guard{m_mutex};
+            m_filter.sync(node_progress(root), resolution);
+        }
+
+    private:
+
+        // alignas makes each shard occupy (at least) one whole cache line, and operator new
+        // honours the alignment, so that no two shards, nor a shard and any other data, share a
+        // line.
+
+        struct alignas(64) shard {
+            std::atomic<std::int64_t> count{0};
+        };
+
+        struct node {
+
+            node(const std::int64_t weight, const std::size_t shard_count)
+              : weight{weight}, shard_count{shard_count},
+                shards{shard_count > 0 ? std::make_unique<shard[]>(shard_count) : nullptr} {}
+
+            std::int64_t weight;
+            std::vector<node_id> children;
+            std::int64_t child_weight = 0;
+
+            std::size_t shard_count;
+            std::unique_ptr<shard[]> shards;
+            std::atomic<std::int64_t> total{0};
+        };
+
+        auto add_node(const node_id parent, const std::int64_t weight, const std::size_t shard_count) -> node_id {
+
+            KSR_ASSERT(parent < m_nodes.size() && m_nodes[parent]->shard_count == 0);
+            KSR_ASSERT(weight >= 0 && weight <= std::numeric_limits<std::int64_t>::max() - m_nodes[parent]->child_weight);
+
+            const auto id = m_nodes.size();
+            m_nodes.push_back(std::make_unique<node>(weight, shard_count));
+            m_nodes[parent]->children.push_back(id);
+            m_nodes[parent]->child_weight += weight;
+            return id;
+        }
+
+        // A leaf's progress is the fraction of its total reported so far (or zero while its total
+        // is unknown); a group's is the weighted mean of its children's (or zero while it has
+        // none). Both round down, so that the root only reaches resolution once every leaf with
+        // a non-zero weight is complete. The products of counts and weights with progress may
+        // exceed 64 bits, so are divided as they are formed (see progress_mul_div()); a group's
+        // children's weights sum to at most INT64_MAX (as add_node() checks).
+
+        auto node_progress(const node_id id) const -> std::int64_t {
+
+            const auto& item = *m_nodes[id];
+
+            if (item.shard_count > 0) {
+
+                const auto total = item.total.load(std::memory_order_relaxed);
+                if (total <= 0) {
+                    return 0;
+                }
+
+                auto count = std::int64_t{0};
+                for (auto i = std::size_t{0}; i < item.shard_count; ++i) {
+                    count += item.shards[i].count.load(std::memory_order_relaxed);
+                }
+
+                return static_cast<std::int64_t>(detail::progress_mul_div(
+                    static_cast<std::uint64_t>(std::clamp(count, std::int64_t{0}, total)),
+                    static_cast<std::uint64_t>(resolution), static_cast<std::uint64_t>(total)).first);
+            }
+
+            if (item.child_weight == 0) {
+                return 0;
+            }
+
+            // The weighted mean's quotient and remainder are accumulated child by child.
+
+            const auto total_weight = static_cast<std::uint64_t>(item.child_weight);
+            auto mean = std::uint64_t{0};
+            auto remainder = std::uint64_t{0};
+
+            for (const auto child : item.children) {
+
+                const auto [quotient, child_remainder] = detail::progress_mul_div(
+                    static_cast<std::uint64_t>(m_nodes[child]->weight),
+                    static_cast<std::uint64_t>(node_progress(child)), total_weight);
+
+                mean += quotient;
+                remainder += child_remainder;
+                if (remainder >= total_weight) {
+                    remainder -= total_weight;
+                    ++mean;
+                }
+            }
+
+            return static_cast<std::int64_t>(mean);
+        }
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<node>> m_nodes;
+        int_percentage_filter<std::int64_t> m_filter;
+    };
+
+    ///
+    /// A handle through which a worker reports progress on one leaf of a \ref progress_tree.
+    /// Handles are cheap to copy, and may be used from any thread without synchronisation.
+    ///
+
+    class progress_tree::leaf {
+    public:
+
+        ///
+        /// Reports the completion of \p count further units of work, adding them to the shard
+        /// for the calling thread.
+        ///
+
+        void advance(const std::int64_t count = 1) const noexcept {
+            m_node->shards[shard_index() % m_node->shard_count].count.fetch_add(
+                count, std::memory_order_relaxed);
+        }
+
+        ///
+        /// Changes the number of units of work after which the leaf is complete, for when it is
+        /// not known at the time the leaf is added.
+        ///
+
+        void set_total(const std::int64_t total) const noexcept {
+            m_node->total.store(total, std::memory_order_relaxed);
+        }
+
+        auto id() const noexcept -> node_id {
+            return m_id;
+        }
+
+    private:
+
+        friend class progress_tree;
+
+        leaf(node* const leaf_node, const node_id id) noexcept
+          : m_node{leaf_node}, m_id{id} {}
+
+        // Threads are numbered consecutively on first use, so that the threads of a pool started
+        // together land in distinct shards of a leaf with a shard per thread.
+
+        static auto shard_index() noexcept -> std::size_t {
+            static auto next_index = std::atomic<std::size_t>{0};
+            thread_local const auto index = next_index.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
+        node* m_node;
+        node_id m_id;
+    };
+
+    inline auto progress_tree::add_leaf(
+        const node_id parent, const std::int64_t weight, const std::int64_t total,
+        const std::size_t shard_count) -> leaf {
+
+        KSR_ASSERT(shard_count > 0);
+
+        const auto lock = std::lock_guard{m_mutex};
+        const auto id = add_node(parent, weight, shard_count);
+        m_nodes[id]->total.store(total, std::memory_order_relaxed);
+        return leaf{m_nodes[id].get(), id};
+    }
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef KSR_SEQLOCK_HPP
+#define KSR_SEQLOCK_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+namespace ksr {
+
+    namespace detail {
+
+        ///
+        /// Values of trivially copyable types, packed without padding into 64-bit words, guarded
+        /// by a seqlock: the sequence number is odd while the values are being replaced, and is
+        /// advanced by two for each publication. Every access to the words is atomic, so readers
+        /// never race with the writer; they merely discard (and retry, or give up on) copies that
+        /// the sequence number shows may be torn, and so never block the writer.
+        ///
+        /// Publishing costs the packing of the values, one store per word and two to the sequence
+        /// number, and a release fence (on x86, all of these are plain moves). The object consists
+        /// of the sequence number followed by the words, all lock-free atomics, so it may also be
+        /// placed in memory shared between processes (see \ref shared_progress_writer).
+        ///
+
+        template <typename... value_ts>
+        class seqlock_words {
+        public:
+
+            static_assert(std::conjunction_v<std::is_trivially_copyable<value_ts>...>,
+                "values guarded by a seqlock must be trivially copyable");
+
+            static constexpr auto byte_count = (std::size_t{0} + ... + sizeof(value_ts));
+            static constexpr auto word_count = (byte_count + 7) / 8;
+
+            using words_t = std::array<std::uint64_t, word_count>;
+
+            static auto pack(const value_ts&... values) noexcept -> words_t {
+
+                auto words = words_t{};
+                auto bytes = reinterpret_cast<unsigned char*>(words.data());
+                ((std::memcpy(bytes, &values, sizeof(value_ts)), bytes += sizeof(value_ts)), ...);
+                return words;
+            }
+
+            static auto unpack(const words_t& words) noexcept -> std::tuple<value_ts...> {
+
+                auto values = std::tuple<value_ts...>{};
+                auto bytes = reinterpret_cast<const unsigned char*>(words.data());
+                std::apply([&](auto&... elements) {
+                    ((std::memcpy(&elements, bytes, sizeof(elements)), bytes += sizeof(elements)), ...);
+                }, values);
+                return values;
+            }
+
+            ///
+            /// Publishes \p values. Only one thread may publish at a time.
+            ///
+
+            void publish(const value_ts&... values) noexcept {
+
+                const auto words = pack(values...);
+                const auto sequence = m_sequence.load(std::memory_order_relaxed);
+
+                m_sequence.store(sequence + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                store_words(words);
+                m_sequence.store(sequence + 2, std::memory_order_release);
+            }
+
+            ///
+            /// Publishes \p values unless another thread is publishing, for values with several
+            /// writers. Returns whether \p values were published.
+            ///
+
+            auto try_publish(const value_ts&... values) noexcept -> bool {
+
+                auto sequence = m_sequence.load(std::memory_order_relaxed);
+                if (sequence % 2 != 0 ||
+                    !m_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+                    return false;
+                }
+
+                std::atomic_thread_fence(std::memory_order_release);
+                store_words(pack(values...));
+                m_sequence.store(sequence + 2, std::memory_order_release);
+                return true;
+            }
+
+            ///
+            /// The values last published (or the values that the words were initialised to),
+            /// retrying for as long as they are being replaced.
+            ///
+
+            auto read() const noexcept -> std::tuple<value_ts...> {
+
+                for (;;) {
+                    if (auto values = try_read()) {
+                        return *values;
+                    }
+                }
+            }
+
+            ///
+            /// The values last published, or an empty optional if they were being replaced.
+            ///
+
+            auto try_read() const noexcept -> std::optional<std::tuple<value_ts...>> {
+
+                const auto before = m_sequence.load(std::memory_order_acquire);
+                if (before % 2 != 0) {
+                    return std::nullopt;
+                }
+
+                const auto words = load_words();
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (m_sequence.load(std::memory_order_relaxed) != before) {
+                    return std::nullopt;
+                }
+
+                return unpack(words);
+            }
+
+            auto publications() const noexcept -> std::uint64_t {
+                return m_sequence.load(std::memory_order_acquire) / 2;
+            }
+
+        private:
+
+            void store_words(const words_t& words) noexcept {
+                for (auto i = std::size_t{0}; i < word_count; ++i) {
+                    m_words[i].store(words[i], std::memory_order_relaxed);
+                }
+            }
+
+            auto load_words() const noexcept -> words_t {
+                auto words = words_t{};
+                for (auto i = std::size_t{0}; i < word_count; ++i) {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+                return words;
+            }
+
+            std::atomic<std::uint64_t> m_sequence{0};
+            std::array<std::atomic<std::uint64_t>, word_count> m_words{};
+        };
+    }
+}
+
+#endif
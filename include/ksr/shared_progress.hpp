@@ -0,0 +1,268 @@
+#ifndef KSR_SHARED_PROGRESS_HPP
+#define KSR_SHARED_PROGRESS_HPP
+
+#if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#define KSR_HAS_SHARED_PROGRESS
+#endif
+
+#ifdef KSR_HAS_SHARED_PROGRESS
+
+#include "seqlock.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ksr {
+
+    namespace detail {
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+            "shared progress needs lock-free 64-bit atomics, which work across processes");
+
+        inline constexpr auto shared_progress_magic = std::uint64_t{0x6b7372'70726f67}; // "ksrprog"
+        inline constexpr auto shared_progress_version = std::uint32_t{1};
+
+        ///
+        /// The header of a shared progress file, which is followed by the data, guarded by a
+        /// seqlock (whose sequence number therefore follows \c layout). \c layout identifies the
+        /// data types well enough to detect a reader expecting different data from those that the
+        /// writer publishes.
+        ///
+
+        struct shared_progress_header {
+            std::atomic<std::uint64_t> magic;
+            std::uint32_t version;
+            std::uint32_t word_count;
+            std::uint64_t layout;
+        };
+
+        template <typename... value_ts>
+        inline constexpr auto shared_progress_layout = [] {
+            auto result = std::uint64_t{sizeof...(value_ts)};
+            ((result = result * 1000003 + sizeof(value_ts) * 4 +
+                (std::is_floating_point_v<value_ts> ? 1 : 0) + (std::is_signed_v<value_ts> ? 2 : 0)), ...);
+            return result;
+        }();
+
+        ///
+        /// An open file descriptor and a mapping of the file, both released on destruction.
+        ///
+
+        class shared_mapping {
+        public:
+
+            shared_mapping(const std::string& path, const bool writable, const std::size_t size) {
+
+                m_fd = writable ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(path.c_str(), O_RDONLY);
+                if (m_fd < 0) {
+                    fail("cannot open " + path);
+                }
+
+                if (writable && ::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+                    release();
+                    fail("cannot size " + path);
+                }
+
+                if (!writable) {
+                    struct stat status;
+                    if (::fstat(m_fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < size) {
+                        release();
+                        throw std::runtime_error{path + " is not a shared progress file of the expected type"};
+                    }
+                }
+
+                const auto protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+                const auto address = ::mmap(nullptr, size, protection, MAP_SHARED, m_fd, 0);
+                if (address == MAP_FAILED) {
+                    release();
+                    fail("cannot map " + path);
+                }
+
+                m_address = address;
+                m_size = size;
+            }
+
+            shared_mapping(shared_mapping&& rhs) noexcept
+              : m_fd{std::exchange(rhs.m_fd, -1)},
+                m_address{std::exchange(rhs.m_address, nullptr)},
+                m_size{std::exchange(rhs.m_size, 0)} {}
+
+            auto operator=(shared_mapping&& rhs) noexcept -> shared_mapping& {
+                if (this != &rhs) {
+                    release();
+                    m_fd = std::exchange(rhs.m_fd, -1);
+                    m_address = std::exchange(rhs.m_address, nullptr);
+                    m_size = std::exchange(rhs.m_size, 0);
+                }
+                return *this;
+            }
+
+            ~shared_mapping() {
+                release();
+            }
+
+            auto address() const noexcept -> void* {
+                return m_address;
+            }
+
+        private:
+
+            [[noreturn]] static void fail(const std::string& what) {
+                throw std::system_error{errno, std::generic_category(), what};
+            }
+
+            void release() noexcept {
+
+                if (m_address) {
+                    ::munmap(m_address, m_size);
+                    m_address = nullptr;
+                }
+
+                if (m_fd >= 0) {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+            }
+
+            int m_fd = -1;
+            void* m_address = nullptr;
+            std::size_t m_size = 0;
+        };
+
+        template <typename... value_ts>
+        struct shared_progress_block {
+            shared_progress_header header;
+            seqlock_words<value_ts...> data;
+        };
+    }
+
+    ///
+    /// A callback for \ref basic_update_filter that publishes each actioned update into a
+    /// memory-mapped file, from which other processes (such as a monitoring daemon) can read the
+    /// latest data with a \ref shared_progress_reader, instead of asking the producer for them.
+    /// Only available (as indicated by \c KSR_HAS_SHARED_PROGRESS) on POSIX systems.
+    ///
+    /// The data are guarded by a seqlock, so publishing never waits for readers: it costs two
+    /// stores to the sequence number and one store per 64-bit word of data, with no system call.
+    /// Each type in \p value_ts must be trivially copyable; the data are packed without padding.
+    ///
+    /// The file is created (or truncated) on construction, and left in place on destruction, so
+    /// that monitors can still read the final data; removing it is up to the caller. The writer
+    /// may be moved, but not copied, so a filter using it should deduce its callback type (see
+    /// \ref update_filter_tag), or hold it through \c std::ref. Only one writer may publish to a
+    /// file at a time.
+    ///
+
+    template <typename... value_ts>
+    class shared_progress_writer {
+    public:
+
+        explicit shared_progress_writer(const std::string& path)
+          : m_mapping{path, true, sizeof(block_t)},
+            m_block{static_cast<block_t*>(m_mapping.address())} {
+
+            // The file is zero-filled by ftruncate(), so readers that find the magic number
+            // (which is stored last) also find the rest of the header.
+
+            auto& header = m_block->header;
+            header.version = detail::shared_progress_version;
+            header.word_count = static_cast<std::uint32_t>(data_t::word_count);
+            header.layout = detail::shared_progress_layout<value_ts...>;
+            header.magic.store(detail::shared_progress_magic, std::memory_order_release);
+        }
+
+        void operator()(const value_ts&... values) {
+            publish(values...);
+        }
+
+        void publish(const value_ts&... values) {
+            m_block->data.publish(values...);
+        }
+
+    private:
+
+        using data_t = detail::seqlock_words<value_ts...>;
+        using block_t = detail::shared_progress_block<value_ts...>;
+
+        detail::shared_mapping m_mapping;
+        block_t* m_block;
+    };
+
+    ///
+    /// Reads the data published by a \ref shared_progress_writer with the same \p value_ts,
+    /// possibly in another process. Once the file has been mapped (on construction), reads make
+    /// no system calls: each copies the data out of the mapping, retrying if the writer was
+    /// publishing meanwhile, so that the data returned were all published together. (A writer
+    /// that dies while publishing therefore leaves readers retrying indefinitely.)
+    ///
+    /// Construction throws \c std::system_error if the file cannot be opened or mapped, and
+    /// \c std::runtime_error if it was not written by a writer of the same data types.
+    ///
+
+    template <typename... value_ts>
+    class shared_progress_reader {
+    public:
+
+        explicit shared_progress_reader(const std::string& path)
+          : m_mapping{path, false, sizeof(block_t)},
+            m_block{static_cast<const block_t*>(m_mapping.address())} {
+
+            const auto& header = m_block->header;
+            if (header.magic.load(std::memory_order_acquire) != detail::shared_progress_magic ||
+                header.version != detail::shared_progress_version ||
+                header.word_count != data_t::word_count ||
+                header.layout != detail::shared_progress_layout<value_ts...>) {
+
+                throw std::runtime_error{path + " is not a shared progress file of the expected type"};
+            }
+        }
+
+        ///
+        /// The number of times that data have been published, which a monitor may compare with
+        /// the value from its last read() to tell whether anything has changed.
+        ///
+
+        auto publications() const noexcept -> std::uint64_t {
+            return m_block->data.publications();
+        }
+
+        ///
+        /// The latest data published, or an empty optional if none have been.
+        ///
+
+        auto read() const -> std::optional<std::tuple<value_ts...>> {
+
+            if (publications() == 0) {
+                return std::nullopt;
+            }
+
+            return m_block->data.read();
+        }
+
+    private:
+
+        using data_t = detail::seqlock_words<value_ts...>;
+        using block_t = detail::shared_progress_block<value_ts...>;
+
+        detail::shared_mapping m_mapping;
+        const block_t* m_block;
+    };
+}
+
+#endif
+
+#endif
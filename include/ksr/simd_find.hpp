@@ -0,0 +1,154 @@
+#ifndef KSR_SIMD_FIND_HPP
+#define KSR_SIMD_FIND_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define KSR_HAS_SIMD_FIND
+#endif
+
+namespace ksr { namespace detail {
+
+    /// Determines whether contiguous ranges of `t` may be searched by comparing object
+    /// representations: integral types (other than `bool`, whose representations aren't
+    /// canonical) and enumerations, of 1, 2, 4 or 8 bytes. Floating-point types are excluded, as
+    /// their equality isn't bitwise.
+
+    template <typename t>
+    inline constexpr auto is_bitwise_searchable_v =
+        ((std::is_integral_v<t> && !std::is_same_v<t, bool>) || std::is_enum_v<t>) &&
+        (sizeof(t) == 1 || sizeof(t) == 2 || sizeof(t) == 4 || sizeof(t) == 8);
+
+#ifdef KSR_HAS_SIMD_FIND
+
+    template <std::size_t size>
+    inline auto compare_sse2(const __m128i block, const __m128i needle) -> __m128i {
+
+        if constexpr (size == 2) {
+            return _mm_cmpeq_epi16(block, needle);
+        } else if constexpr (size == 4) {
+            return _mm_cmpeq_epi32(block, needle);
+        } else {
+            // SSE2 lacks a 64-bit comparison: a quadword matches if both of its halves do.
+            const auto halves = _mm_cmpeq_epi32(block, needle);
+            return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+
+    template <typename t>
+    auto find_sse2(const t* first, const t* const last, const t value) -> const t* {
+
+        using word_t = std::conditional_t<sizeof(t) == 2, std::int16_t,
+            std::conditional_t<sizeof(t) == 4, std::int32_t, std::int64_t>>;
+
+        auto word = word_t{};
+        std::memcpy(&word, &value, sizeof(t));
+
+        const auto needle = sizeof(t) == 8
+            ? _mm_set1_epi64x(static_cast<std::int64_t>(word))
+            : sizeof(t) == 4 ? _mm_set1_epi32(static_cast<std::int32_t>(word))
+            : _mm_set1_epi16(static_cast<std::int16_t>(word));
+
+        constexpr auto lanes = std::size_t{16} / sizeof(t);
+        for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+
+            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if (const auto mask = _mm_movemask_epi8(compare_sse2<sizeof(t)>(block, needle))) {
+                return first + __builtin_ctz(static_cast<unsigned>(mask)) / sizeof(t);
+            }
+        }
+
+        for (; first != last; ++first) {
+            if (std::memcmp(first, &value, sizeof(t)) == 0) {
+                return first;
+            }
+        }
+
+        return last;
+    }
+
+    template <std::size_t size>
+    __attribute__((target("avx2"))) inline auto compare_avx2(const __m256i block, const __m256i needle) -> __m256i {
+
+        if constexpr (size == 2) {
+            return _mm256_cmpeq_epi16(block, needle);
+        } else if constexpr (size == 4) {
+            return _mm256_cmpeq_epi32(block, needle);
+        } else {
+            return _mm256_cmpeq_epi64(block, needle);
+        }
+    }
+
+    // Scans two vectors per iteration, combining their comparisons, so that the loop runs at
+    // close to the load bandwidth; the position of a match is only worked out once one is found.
+
+    template <typename t>
+    __attribute__((target("avx2"))) auto find_avx2(const t* first, const t* const last, const t value) -> const t* {
+
+        using word_t = std::conditional_t<sizeof(t) == 2, std::int16_t,
+            std::conditional_t<sizeof(t) == 4, std::int32_t, std::int64_t>>;
+
+        auto word = word_t{};
+        std::memcpy(&word, &value, sizeof(t));
+
+        const auto needle = sizeof(t) == 8
+            ? _mm256_set1_epi64x(static_cast<std::int64_t>(word))
+            : sizeof(t) == 4 ? _mm256_set1_epi32(static_cast<std::int32_t>(word))
+            : _mm256_set1_epi16(static_cast<std::int16_t>(word));
+
+        constexpr auto lanes = std::size_t{32} / sizeof(t);
+        for (; static_cast<std::size_t>(last - first) >= 2 * lanes; first += 2 * lanes) {
+
+            const auto lo = compare_avx2<sizeof(t)>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)), needle);
+            const auto hi = compare_avx2<sizeof(t)>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + lanes)), needle);
+
+            if (!_mm256_testz_si256(_mm256_or_si256(lo, hi), _mm256_or_si256(lo, hi))) {
+                if (const auto mask = _mm256_movemask_epi8(lo)) {
+                    return first + __builtin_ctz(static_cast<unsigned>(mask)) / sizeof(t);
+                }
+                return first + lanes + __builtin_ctz(static_cast<unsigned>(_mm256_movemask_epi8(hi))) / sizeof(t);
+            }
+        }
+
+        return find_sse2(first, last, value);
+    }
+
+    inline auto has_avx2() noexcept -> bool {
+        static const auto result = __builtin_cpu_supports("avx2") != 0;
+        return result;
+    }
+
+#endif
+
+    /// Finds the first element of the contiguous range `[first, last)` whose object representation
+    /// is the same as that of `value`, as per `is_bitwise_searchable_v`: via `std::memchr()` for
+    /// bytes, and otherwise via SSE2 or (where the processor supports it, as detected at run time)
+    /// AVX2 comparisons on x86, or a simple loop elsewhere.
+
+    template <typename t, typename = std::enable_if_t<is_bitwise_searchable_v<t>>>
+    auto find_bitwise(const t* const first, const t* const last, const t value) -> const t* {
+
+        if constexpr (sizeof(t) == 1) {
+            auto byte = static_cast<unsigned char>(0);
+            std::memcpy(&byte, &value, 1);
+            const auto found = std::memchr(first, byte, static_cast<std::size_t>(last - first));
+            return found ? static_cast<const t*>(found) : last;
+        } else {
+#ifdef KSR_HAS_SIMD_FIND
+            return has_avx2() ? find_avx2(first, last, value) : find_sse2(first, last, value);
+#else
+            auto iter = first;
+            while (iter != last && !(*iter == value)) {
+                ++iter;
+            }
+            return iter;
+#endif
+        }
+    }
+}}
+
+#endif
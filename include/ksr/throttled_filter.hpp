@@ -0,0 +1,185 @@
+#ifndef KSR_THROTTLED_FILTER_HPP
+#define KSR_THROTTLED_FILTER_HPP
+
+#include "timer_wheel.hpp"
+#include "update_filter.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ksr {
+
+    ///
+    /// Selects which edges of each throttling window a \ref basic_throttled_filter delivers
+    /// updates on. A window opens with the first update received while no window is open, and
+    /// lasts for the filter's interval.
+    ///
+    /// - \c leading delivers that first update immediately and discards any others received
+    ///   during the window (the behaviour of filter_policy::sampled).
+    /// - \c trailing delivers nothing immediately; when the window closes, the most recent update
+    ///   received during it is delivered.
+    /// - \c both delivers the first update immediately and, when the window closes, the most
+    ///   recent update received since (if any).
+    ///
+    /// Whenever a trailing update is delivered, a new window opens, so that deliveries never occur
+    /// more often than once per interval. With \c trailing or \c both, the last update of a burst
+    /// is therefore always delivered within one interval, without the producer calling sync().
+    ///
+
+    enum class throttle_edge { leading, trailing, both };
+
+    ///
+    /// A counterpart of \ref basic_update_filter that rate-limits updates to one per interval, as
+    /// for filter_policy::sampled, but can also defer the last update received within an interval
+    /// until the interval ends (see \ref throttle_edge). This cannot be expressed as an
+    /// update_filter policy, as trailing updates must be delivered when no call to update() is
+    /// in progress: they are instead delivered from a \ref timer_wheel thread (by default, that of
+    /// timer_wheel::shared()), so that any number of throttled filters can share one thread.
+    ///
+    /// update() and sync() may be called from any thread. The callback is invoked with the
+    /// filter's internal mutex held, which serialises deliveries from the producer and the timer
+    /// thread; the callback must therefore not call back into the same filter. As the timer
+    /// thread refers to the filter, a \ref basic_throttled_filter can be neither copied nor moved.
+    ///
+
+    template <throttle_edge edge, typename callback_t, typename... value_ts>
+    class basic_throttled_filter {
+    public:
+
+        template <std::size_t index>
+        friend auto adl_get(const basic_throttled_filter& self) {
+            const auto lock = std::lock_guard{self.m_mutex};
+            return std::get<index>(self.m_last_values);
+        }
+
+        explicit basic_throttled_filter(
+            const std::chrono::milliseconds interval, callback_t update,
+            timer_wheel& wheel = timer_wheel::shared())
+          : m_interval{interval}, m_update{std::move(update)}, m_wheel{wheel} {}
+
+        basic_throttled_filter(const basic_throttled_filter&) = delete;
+        auto operator=(const basic_throttled_filter&) -> basic_throttled_filter& = delete;
+
+        ~basic_throttled_filter() {
+
+            // Once m_closing is set, close_window() won't schedule another timer, so cancelling the
+            // current one (which waits for it if it's already running) is enough to ensure that
+            // the wheel no longer refers to this filter.
+
+            auto timer = std::optional<timer_wheel::timer_id>{};
+            {
+                const auto lock = std::lock_guard{m_mutex};
+                m_closing = true;
+                timer = m_timer;
+            }
+
+            if (timer) {
+                m_wheel.cancel(*timer);
+            }
+        }
+
+        ///
+        /// Delivers \p new_values immediately, discarding any pending trailing update. The current
+        /// window (if any) stays open, so the next update is still subject to throttling.
+        ///
+
+        void sync(const value_ts&... new_values) {
+            const auto lock = std::lock_guard{m_mutex};
+            m_pending.reset();
+            deliver(new_values...);
+        }
+
+        ///
+        /// Delivers \p new_values immediately if they open a new window and \p edge includes the
+        /// leading edge, returning \c true if so; otherwise (for \c trailing and \c both) retains
+        /// them to be delivered when the current window closes, unless superseded by a later call.
+        ///
+
+        auto update(const value_ts&... new_values) -> bool {
+
+            const auto lock = std::lock_guard{m_mutex};
+
+            if (!m_timer) {
+                open_window();
+
+                if constexpr (edge != throttle_edge::trailing) {
+                    deliver(new_values...);
+                    return true;
+                }
+            }
+
+            if constexpr (edge != throttle_edge::leading) {
+                m_pending.emplace(new_values...);
+            }
+
+            return false;
+        }
+
+    private:
+
+        void open_window() {
+            m_timer = m_wheel.schedule(m_interval, [this] { close_window(); });
+        }
+
+        void close_window() {
+
+            const auto lock = std::lock_guard{m_mutex};
+
+            if (m_pending && *m_pending != m_last_values && !m_closing) {
+                std::apply([this](const auto&... values) { deliver(values...); }, *m_pending);
+                m_pending.reset();
+                open_window();
+            } else {
+                m_pending.reset();
+                m_timer.reset();
+            }
+        }
+
+        void deliver(const value_ts&... new_values) {
+            std::invoke(m_update, new_values...);
+            m_last_values = std::tie(new_values...);
+        }
+
+        std::chrono::milliseconds m_interval;
+        callback_t m_update;
+        timer_wheel& m_wheel;
+
+        mutable std::mutex m_mutex;
+        std::tuple<value_ts...> m_last_values;
+        std::optional<std::tuple<value_ts...>> m_pending;
+        std::optional<timer_wheel::timer_id> m_timer;
+        bool m_closing = false;
+    };
+
+    template <throttle_edge edge, typename... value_ts>
+    using throttled_filter = basic_throttled_filter<edge, std::function<void(value_ts...)>, value_ts...>;
+}
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmismatched-tags"
+#endif
+
+namespace std {
+
+    template <std::size_t index, ksr::throttle_edge edge, typename callback_t, typename... value_ts>
+    struct tuple_element<index, ksr::basic_throttled_filter<edge, callback_t, value_ts...>> {
+        using type = std::tuple_element_t<index, std::tuple<value_ts...>>;
+    };
+
+    template <ksr::throttle_edge edge, typename callback_t, typename... value_ts>
+    struct tuple_size<ksr::basic_throttled_filter<edge, callback_t, value_ts...>>
+        : public std::integral_constant<std::size_t, sizeof...(value_ts)> {};
+}
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef KSR_TIMER_WHEEL_HPP
+#define KSR_TIMER_WHEEL_HPP
+
+#include "error.hpp"
+#include "inplace_function.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ksr {
+
+    ///
+    /// Runs deferred tasks on a single background thread, so that large numbers of components can
+    /// schedule short delays (such as the trailing edge of a \ref basic_throttled_filter) without
+    /// each owning a thread or an OS timer. Tasks are kept in a hashed timing wheel: a ring of
+    /// \p slot_count slots, each covering one tick, into which a task is placed according to its
+    /// expiry tick modulo the ring size. Scheduling and cancelling are therefore constant-time
+    /// (with a short scan of one slot to cancel), and the background thread only wakes once per
+    /// tick while any task is pending.
+    ///
+    /// Delays are rounded up to a whole number of ticks, so a task never runs early but may run
+    /// up to one tick (plus scheduling latency) late. Tasks run on the wheel's thread, one at a
+    /// time, and should be brief; they may schedule or cancel other tasks.
+    ///
+
+    class timer_wheel {
+    public:
+
+        using clock = std::chrono::steady_clock;
+        using task = inplace_function<void()>;
+        using timer_id = std::uint64_t;
+
+        explicit timer_wheel(
+            const clock::duration tick = std::chrono::milliseconds{1},
+            const std::size_t slot_count = 512)
+          : m_tick{tick}, m_slots(slot_count), m_start{clock::now()} {
+
+            KSR_ASSERT(tick > clock::duration::zero());
+            KSR_ASSERT(slot_count > 0);
+            m_thread = std::thread{[this] { run(); }};
+        }
+
+        timer_wheel(const timer_wheel&) = delete;
+        auto operator=(const timer_wheel&) -> timer_wheel& = delete;
+
+        ~timer_wheel() {
+
+            {
+                const auto lock = std::lock_guard{m_mutex};
+                m_stopping = true;
+            }
+
+            m_wake.notify_all();
+            m_thread.join();
+        }
+
+        ///
+        /// The process-wide wheel with the default tick, started on first use.
+        ///
+
+        static auto shared() -> timer_wheel& {
+            static auto instance = timer_wheel{};
+            return instance;
+        }
+
+        ///
+        /// Schedules \p fn to run on the wheel's thread once \p delay has elapsed, and returns an
+        /// identifier that may be passed to cancel().
+        ///
+
+        auto schedule(const clock::duration delay, task fn) -> timer_id {
+
+            const auto lock = std::lock_guard{m_mutex};
+
+            const auto elapsed = clock::now() - m_start + std::max(delay, clock::duration::zero());
+            const auto expiry = static_cast<std::uint64_t>((elapsed + m_tick - clock::duration{1}) / m_tick);
+            const auto slot = static_cast<std::size_t>(expiry % m_slots.size());
+
+            // The slot is encoded in the identifier so that cancel() knows where to look.
+
+            const auto id = ++m_next_sequence * m_slots.size() + slot;
+            m_slots[slot].push_back(entry{id, expiry, std::move(fn)});
+            ++m_pending;
+
+            if (expiry < m_next_expiry) {
+                m_next_expiry = expiry;
+                m_wake.notify_one();
+            }
+
+            return id;
+        }
+
+        ///
+        /// Cancels the task identified by \p id, returning \c true if it had not yet started to run.
+        /// If the task is running on the wheel's thread at the time of the call (and the caller is
+        /// not that thread), waits for it to finish, so that on return the task is guaranteed not
+        /// to be accessing anything it captured.
+        ///
+
+        auto cancel(const timer_id id) -> bool {
+
+            auto lock = std::unique_lock{m_mutex};
+
+            auto& slot = m_slots[static_cast<std::size_t>(id % m_slots.size())];
+            const auto iter = std::find_if(slot.begin(), slot.end(), [id](const entry& item) {
+                return item.id == id;
+            });
+
+            if (iter != slot.end()) {
+                slot.erase(iter);
+                --m_pending;
+                return true;
+            }
+
+            // A task may also have expired without yet having started, if others due on the same
+            // tick are still running.
+
+            const auto due = std::find_if(m_due.begin(), m_due.end(), [id](const entry& item) {
+                return item.id == id;
+            });
+
+            if (due != m_due.end()) {
+                m_due.erase(due);
+                return true;
+            }
+
+            if (std::this_thread::get_id() != m_thread.get_id()) {
+                m_task_done.wait(lock, [this, id] { return m_running != id; });
+            }
+
+            return false;
+        }
+
+    private:
+
+        struct entry {
+            timer_id id;
+            std::uint64_t expiry;
+            task fn;
+        };
+
+        static constexpr auto no_expiry = UINT64_MAX;
+
+        void run() {
+
+            auto lock = std::unique_lock{m_mutex};
+
+            while (!m_stopping) {
+
+                if (m_pending == 0) {
+                    m_next_expiry = no_expiry;
+                    m_wake.wait(lock, [this] { return m_stopping || m_pending > 0; });
+                    continue;
+                }
+
+                const auto now_tick = static_cast<std::uint64_t>((clock::now() - m_start) / m_tick);
+                if (now_tick < m_next_expiry) {
+                    m_wake.wait_until(lock, m_start + m_tick * m_next_expiry);
+                    continue;
+                }
+
+                // Visit each tick that has passed since the wheel last turned (at most one full
+                // revolution), collecting the tasks that have expired.
+
+                const auto last_tick = std::min(now_tick, m_current_tick + m_slots.size());
+                for (; m_current_tick <= last_tick; ++m_current_tick) {
+
+                    auto& slot = m_slots[static_cast<std::size_t>(m_current_tick % m_slots.size())];
+                    const auto expired = std::stable_partition(slot.begin(), slot.end(),
+                        [now_tick](const entry& item) { return item.expiry > now_tick; });
+
+                    std::move(expired, slot.end(), std::back_inserter(m_due));
+                    slot.erase(expired, slot.end());
+                }
+
+                // Rather than search the wheel for the earliest remaining expiry, simply turn it
+                // again on the next tick; that is how a timing wheel is meant to be driven, and
+                // the thread sleeps indefinitely once nothing is pending.
+
+                m_current_tick = now_tick;
+                m_pending -= m_due.size();
+                m_next_expiry = now_tick + 1;
+
+                // Expired tasks are taken one at a time, under the lock, so that cancel() can
+                // still remove any that haven't started.
+
+                while (!m_due.empty()) {
+
+                    auto item = std::move(m_due.front());
+                    m_due.pop_front();
+
+                    m_running = item.id;
+                    lock.unlock();
+                    item.fn();
+                    lock.lock();
+                    m_running = 0;
+                    m_task_done.notify_all();
+                }
+            }
+        }
+
+        clock::duration m_tick;
+        std::vector<std::vector<entry>> m_slots;
+        std::deque<entry> m_due;
+        clock::time_point m_start;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_task_done;
+
+        std::uint64_t m_current_tick = 0;
+        std::uint64_t m_next_expiry = no_expiry;
+        std::uint64_t m_next_sequence = 0;
+        std::size_t m_pending = 0;
+        timer_id m_running = 0;
+        bool m_stopping = false;
+
+        std::thread m_thread;
+    };
+}
+
+#endif
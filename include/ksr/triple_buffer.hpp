@@ -0,0 +1,77 @@
+#ifndef KSR_TRIPLE_BUFFER_HPP
+#define KSR_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace ksr {
+
+    ///
+    /// A wait-free single-producer, single-consumer channel that conveys only the latest value
+    /// written to it. The producer writes into a back buffer and publishes it by swapping it with
+    /// a shared middle buffer; the consumer takes the middle buffer (if it has been published to
+    /// since the last take) by swapping it with its front buffer. Neither side ever blocks or
+    /// allocates, and values the consumer is too slow to take are simply overwritten.
+    ///
+    /// Exactly one thread may call write() at a time, and exactly one (possibly different) thread
+    /// may call take() at a time. \p t must be default-constructible.
+    ///
+    /// Publication and the check for a published value are sequentially consistent, so that a
+    /// caller may pair them with a flag of its own (as \ref basic_async_callback does to decide
+    /// when to schedule the consumer) without a missed wake-up.
+    ///
+
+    template <typename t>
+    class triple_buffer {
+    public:
+
+        ///
+        /// Publishes \p value, replacing any value published earlier but not yet taken.
+        ///
+
+        template <typename value_t>
+        void write(value_t&& value) {
+            m_buffers[m_back] = std::forward<value_t>(value);
+            m_back = m_middle.exchange(m_back | dirty) & index_mask;
+        }
+
+        ///
+        /// If a value has been published since the last call, moves it into \p value and returns
+        /// \c true; otherwise returns \c false, leaving \p value unchanged.
+        ///
+
+        auto take(t& value) -> bool {
+
+            if (!pending()) {
+                return false;
+            }
+
+            m_front = m_middle.exchange(m_front) & index_mask;
+            value = std::move(m_buffers[m_front]);
+            return true;
+        }
+
+        ///
+        /// Returns \c true if a value has been published since the last call to take(). May only
+        /// be called by the consumer.
+        ///
+
+        auto pending() const -> bool {
+            return m_middle.load() & dirty;
+        }
+
+    private:
+
+        static constexpr auto dirty = std::uint8_t{0x4};
+        static constexpr auto index_mask = std::uint8_t{0x3};
+
+        std::array<t, 3> m_buffers{};
+        std::uint8_t m_back = 0;
+        std::atomic<std::uint8_t> m_middle{1};
+        std::uint8_t m_front = 2;
+    };
+}
+
+#endif
@@ -1,138 +1,549 @@
 #ifndef KSR_UPDATE_FILTER_HPP
 #define KSR_UPDATE_FILTER_HPP
 
+#include "inplace_function.hpp"
 #include "math.hpp"
+#include "seqlock.hpp"
 
+#ifdef KSR_UPDATE_FILTER_STATS
+#include "filter_stats.hpp"
+#endif
+
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <optional>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 
 namespace ksr {
 
-    template <template <typename...> class policy, typename... value_ts>
-    class update_filter;
+    namespace detail {
+
+#ifndef KSR_UPDATE_FILTER_STATS
+
+        ///
+        /// Without statistics (see ksr/filter_stats.hpp), a filter's instrumentation points
+        /// compile to nothing, and the filter has no statistics record: this empty base stands
+        /// in for it.
+        ///
+
+        class update_filter_stats {
+        public:
+
+            void set_stats_name(std::string_view) noexcept {}
+
+        protected:
+
+            void count_update(bool) noexcept {}
+
+            void count_sync() noexcept {}
+
+            template <typename fn_t>
+            void invoke_timed(fn_t&& fn) {
+                std::forward<fn_t>(fn)();
+            }
+        };
+
+#endif
+
+        template <typename policy_t, typename... value_ts>
+        class update_filter_state;
+
+        template <std::size_t index, typename policy_t, typename... value_ts>
+        decltype(auto) adl_get(const update_filter_state<policy_t, value_ts...>& self);
+
+        ///
+        /// The part of a \ref basic_update_filter that is independent of its callback type: the
+        /// policy base and the last-actioned data. Policies that need to inspect those data (e.g.
+        /// filter_policy::int_percentage::count()) downcast to this class rather than to the
+        /// complete filter type, which they cannot name without also knowing the callback type.
+        ///
+
+        template <typename policy_t, typename... value_ts>
+        class update_filter_state : public policy_t {
+        public:
+
+            // We have to jump through hoops to implement ksr::get() as a free function, but
+            // consistency with the standard library is nice. It's impractical to implement
+            // ksr::get() as an out-of-line friend, but somewhat nicer to expose an adl_get() friend
+            // accessible only via ADL that provides the implementation. (This also facilitates a
+            // single implementation of ksr::get() for all tuple-like custom types.)
+
+            template <std::size_t index>
+            friend decltype(auto) adl_get(const update_filter_state& self) {
+                return std::get<index>(self.m_last_values);
+            }
+
+        protected:
+
+            update_filter_state() = default;
+
+            template <typename t>
+            explicit update_filter_state(const t& policy_data)
+              : policy_t{policy_data} {}
+
+            ///
+            /// Informs the policy, if it provides an on_update() member function, that
+            /// m_last_values has just been replaced (whether by an accepted update or by sync()).
+            ///
+
+            void notify_policy() {
+                if constexpr (has_on_update<update_filter_state>(int{})) {
+                    policy_t::on_update(m_last_values);
+                }
+            }
+
+            ///
+            /// Invokes \p callback with \p values, followed by the policy's callback_state() if
+            /// the policy provides one and \p callback can't be invoked with \p values alone.
+            ///
+
+            template <typename callback_t>
+            void invoke_callback(callback_t& callback, const value_ts&... values) {
+                if constexpr (!std::is_invocable_v<callback_t&, const value_ts&...> &&
+                    has_callback_state<update_filter_state>(int{})) {
+                    callback(values..., policy_t::callback_state());
+                } else {
+                    callback(values...);
+                }
+            }
+
+            std::tuple<value_ts...> m_last_values;
+
+        private:
+
+            // Policy members are typically protected, so detection has to take place within the
+            // scope of a derived class.
+
+            template <typename self_t>
+            static constexpr auto has_on_update(int) -> decltype(
+                std::declval<self_t&>().on_update(std::declval<const std::tuple<value_ts...>&>()),
+                bool{}) { return true; }
+
+            template <typename self_t>
+            static constexpr auto has_on_update(...) -> bool { return false; }
+
+            template <typename self_t>
+            static constexpr auto has_callback_state(int) -> decltype(
+                std::declval<const self_t&>().callback_state(), bool{}) { return true; }
+
+            template <typename self_t>
+            static constexpr auto has_callback_state(...) -> bool { return false; }
+        };
+    }
+
+    namespace detail {
+
+        ///
+        /// Identifies the policies of filters whose last-actioned data are guarded for concurrent
+        /// reading (see filter_policy::snapshot), and the policy that such filters actually apply.
+        ///
+
+        template <typename policy_t, typename = void>
+        struct snapshot_policy_traits {
+            using type = policy_t;
+            static constexpr auto enabled = false;
+        };
+
+        template <typename policy_t>
+        struct snapshot_policy_traits<policy_t, std::void_t<typename policy_t::snapshot_inner_type>> {
+            using type = typename policy_t::snapshot_inner_type;
+            static constexpr auto enabled = true;
+        };
+
+        ///
+        /// The seqlock through which a filter with concurrent snapshot reads publishes a copy of
+        /// its last-actioned data (see seqlock_words), which may be copied with the filter. Empty
+        /// otherwise.
+        ///
+
+        template <bool enabled, typename... value_ts>
+        class update_filter_snapshot {};
+
+        template <typename... value_ts>
+        class update_filter_snapshot<true, value_ts...> {
+        protected:
+
+            // The copy starts out as the value-initialised data with which update_filter_state
+            // starts out.
+
+            update_filter_snapshot() noexcept {
+                publish(std::tuple<value_ts...>{});
+            }
+
+            update_filter_snapshot(const update_filter_snapshot& other) noexcept {
+                publish(other.read());
+            }
+
+            auto operator=(const update_filter_snapshot& other) noexcept -> update_filter_snapshot& {
+                publish(other.read());
+                return *this;
+            }
+
+            void publish(const std::tuple<value_ts...>& values) noexcept {
+                std::apply([&](const auto&... elements) { m_seqlock.publish(elements...); }, values);
+            }
+
+            auto read() const noexcept -> std::tuple<value_ts...> {
+                return m_seqlock.read();
+            }
+
+        private:
+
+            seqlock_words<value_ts...> m_seqlock;
+        };
+    }
 
-    template <std::size_t index, template <typename...> class policy, typename... value_ts>
-    decltype(auto) adl_get(const update_filter<policy, value_ts...>& self);
+    ///
+    /// Empty tag type that specifies the policy and data types of a \ref basic_update_filter when
+    /// passed as the first constructor argument, allowing the callback type to be deduced from the
+    /// remaining arguments. For example,
+    /// ```c++
+    /// auto filter = basic_update_filter{update_filter_tag<filter_policy::sampled, int>{}, 20ms,
+    ///     [&](const int value) { ... }};
+    /// ```
+    /// stores the lambda directly, rather than through a \c std::function.
+    ///
+
+    template <template <typename...> class policy, typename... value_ts>
+    struct update_filter_tag {};
 
     ///
-    /// A generalised component for filtering updates. An \ref update_filter instance is created for
-    /// a specified callback; then, when successive calls to update() are made, the argument data
-    /// are compared with the last actioned data as per policy_t::can_update(). If the policy
-    /// indicates that the new data are sufficiently different to the last actioned data, the
-    /// callback function for the \ref update_filter instance is invoked with those new data.
+    /// A generalised component for filtering updates. A \ref basic_update_filter instance is
+    /// created for a specified callback; then, when successive calls to update() are made, the
+    /// argument data are compared with the last actioned data as per policy_t::can_update(). If the
+    /// policy indicates that the new data are sufficiently different to the last actioned data, the
+    /// callback function for the \ref basic_update_filter instance is invoked with those new data.
     ///
     /// This is useful when there is a need to notify other components of updates from a
     /// long-running process, but the source data are changing rapidly and it is impractical to send
     /// that notification every time a change occurs. (For example, when sending signals over Qt
-    /// connections.) Once the process that the \ref update_filter is responding to completes,
+    /// connections.) Once the process that the \ref basic_update_filter is responding to completes,
     /// sync() may be called to force an update with the final data.
     ///
-    /// Each update_filter instance stores a tuple of data to manage updates to. New values for each
-    /// element of this tuple are passed as the arguments to update(). Upon construction of the
-    /// update_filter, the initial data are value-initialised. (Each type in \p value_ts must
-    /// therefore support this mode of initialisation.) The last-actioned data stored in the
-    /// update_filter may be retrieved at any time via ksr::get() or a decomposition declaration
-    /// (just as for \c std::tuple).
+    /// Each basic_update_filter instance stores a tuple of data to manage updates to. New values
+    /// for each element of this tuple are passed as the arguments to update(). Upon construction of
+    /// the basic_update_filter, the initial data are value-initialised. (Each type in \p value_ts
+    /// must therefore support this mode of initialisation.) The last-actioned data stored in the
+    /// basic_update_filter may be retrieved at any time via ksr::get() or a decomposition
+    /// declaration (just as for \c std::tuple), or via snapshot(). Only the thread updating the
+    /// filter may do so, unless the policy is wrapped in filter_policy::snapshot, in which case
+    /// any thread may.
+    ///
+    /// The callback is stored as an object of type \p callback_t, which must be invocable with
+    /// arguments of types \p value_ts, or, if the policy passes state of its own to callbacks
+    /// (as filter_policy::adaptive_rate passes its \ref filter_policy::rate_estimate), with
+    /// those arguments followed by that state. The \ref update_filter alias stores a \c std::function;
+    /// when the callback type is instead the closure type itself (as deduced when constructing a
+    /// basic_update_filter from an \ref update_filter_tag), no allocation takes place and the
+    /// callback may be inlined into update(). \ref inplace_update_filter provides a type-erased
+    /// middle ground that never allocates. The callback is invoked synchronously on the thread
+    /// calling update() or sync(); to deliver updates on another thread without blocking the
+    /// producer, use a \ref basic_async_callback as the callback.
+    ///
+    /// If \c KSR_UPDATE_FILTER_STATS is defined, each filter also counts its calls to update()
+    /// and sync() and times its callback, for inspection via ksr::filter_stats() (see
+    /// ksr/filter_stats.hpp); set_stats_name() labels the filter in those statistics. This makes
+    /// each filter over a kilobyte larger, and its construction, copying and destruction take a
+    /// global lock, so statistics are best kept to diagnostic builds. Otherwise, the filter
+    /// doesn't include the statistics at all.
     ///
     /// Policies must provide a member function with the signature
     /// ```c++
     /// bool can_update(
     ///     const std::tuple<value_ts...>& current_values,
-    ///     const std::tuple<value_ts...>& new_values) const
+    ///     const std::tuple<const value_ts&...>& new_values) const
     /// ```
     /// that specifies whether an update should be actioned when the data \p new_values are passed
-    /// to an \ref update_filter whose last-actioned data are \p current_values. Additionally,
+    /// to a \ref basic_update_filter whose last-actioned data are \p current_values. The new data
+    /// are passed by reference so that rejecting an update need not copy them. (A policy taking
+    /// \p new_values as <tt>const std::tuple<value_ts...>&</tt> still works, but reinstates that
+    /// copy.) Additionally,
     /// policies that require data of their own should provide an appropriate constructor (refer to
-    /// the constructor of \ref update_filter).
+    /// the constructor of \ref basic_update_filter).
+    ///
+    /// Policies that cache state derived from the last-actioned data may also provide a member
+    /// function
+    /// ```c++
+    /// void on_update(const std::tuple<value_ts...>& current_values)
+    /// ```
+    /// which is called whenever those data are replaced, either because can_update() accepted an
+    /// update or because sync() was called.
+    ///
+    /// Policies with state that callbacks may want alongside the data (such as a measured rate)
+    /// may provide a member function
+    /// ```c++
+    /// state_t callback_state() const
+    /// ```
+    /// whose result is passed as an extra, last argument to callbacks that cannot be invoked
+    /// with the data alone.
     ///
 
-    template <template <typename...> class policy, typename... value_ts>
-    class update_filter : public policy<value_ts...> {
+    template <template <typename...> class policy, typename callback_t, typename... value_ts>
+    class basic_update_filter
+        : public detail::update_filter_state<
+              typename detail::snapshot_policy_traits<policy<value_ts...>>::type, value_ts...>,
+          public detail::update_filter_stats,
+          private detail::update_filter_snapshot<
+              detail::snapshot_policy_traits<policy<value_ts...>>::enabled, value_ts...> {
     private:
 
-        using policy_t = policy<value_ts...>;
-        using update_fn = std::function<void(value_ts...)>;
+        using policy_t = typename detail::snapshot_policy_traits<policy<value_ts...>>::type;
+        using state_t = detail::update_filter_state<policy_t, value_ts...>;
         static constexpr auto needs_policy_data = !std::is_default_constructible_v<policy_t>;
+        static constexpr auto snapshot_reads = detail::snapshot_policy_traits<policy<value_ts...>>::enabled;
+
+        static_assert(!snapshot_reads || std::conjunction_v<std::is_trivially_copyable<value_ts>...>,
+            "filters with snapshot reads must store trivially copyable data");
+
+        // Selects the rvalue overloads of update() and sync() (which are templates only so that
+        // they remain distinct from the const-reference overloads when value_ts is empty): arg_ts
+        // is deduced as exactly value_ts when every argument is an rvalue of the stored type.
+
+        template <typename... arg_ts>
+        static constexpr auto are_values_v = sizeof...(arg_ts) == sizeof...(value_ts) &&
+            sizeof...(arg_ts) > 0 && std::conjunction_v<std::is_same<arg_ts, value_ts>...>;
 
     public:
 
-        // We have to jump through hoops to implement ksr::get() as a free function, but consistency
-        // with the standard library is nice. It's impractical to implement ksr::get() as an
-        // out-of-line friend, but somewhat nicer to expose an adl_get() friend accessible only via
-        // ADL that provides the implementation. (This also facilitates a single implementation of
-        // ksr::get() for all tuple-like custom types.)
+        // For filters with snapshot reads, this hides the adl_get() of update_filter_state (by
+        // being a better match), so that ksr::get() reads each element under the seqlock.
 
         template <std::size_t index>
-        friend decltype(auto) adl_get(const update_filter& self) {
-            return std::get<index>(self.m_last_values);
+        friend decltype(auto) adl_get(const basic_update_filter& self) {
+            if constexpr (snapshot_reads) {
+                return std::tuple_element_t<index, std::tuple<value_ts...>>{std::get<index>(self.snapshot())};
+            } else {
+                return std::get<index>(self.m_last_values);
+            }
         }
 
         ///
         /// Depending on the type of filtering performed by this instantiation of
-        /// \ref update_filter (which is determined by its \p policy_t template argument), it may
-        /// be necessary to initialise it with policy-specific data that configures the filtering.
-        /// If this is the case, \p policy_t should provide (only) a non-default constructor taking
-        /// a single parameter; an appropriate value for this parameter can then be passed as the
-        /// first argument to the \ref update_filter constructor.
+        /// \ref basic_update_filter (which is determined by its \p policy_t template argument), it
+        /// may be necessary to initialise it with policy-specific data that configures the
+        /// filtering. If this is the case, \p policy_t should provide (only) a non-default
+        /// constructor taking a single parameter; an appropriate value for this parameter can then
+        /// be passed as the first argument to the \ref basic_update_filter constructor.
         ///
 
-        explicit update_filter(update_fn update)
+        explicit basic_update_filter(callback_t update)
           : m_update{std::move(update)} {}
 
         template <typename t>
-        explicit update_filter(const t& policy_data, update_fn update)
-          : policy_t{policy_data}, m_update{std::move(update)} {}
+        explicit basic_update_filter(const t& policy_data, callback_t update)
+          : state_t{policy_data}, m_update{std::move(update)} {}
+
+        ///
+        /// These constructors match the deduction guides taking an \ref update_filter_tag, through
+        /// which the policy and data types are specified explicitly while the callback type is
+        /// deduced.
+        ///
+
+        explicit basic_update_filter(update_filter_tag<policy, value_ts...>, callback_t update)
+          : m_update{std::move(update)} {}
+
+        template <typename t>
+        explicit basic_update_filter(
+            update_filter_tag<policy, value_ts...>, const t& policy_data, callback_t update)
+          : state_t{policy_data}, m_update{std::move(update)} {}
 
         ///
         /// Performs the update action of update() unconditionally (that is, without checking if the
         /// filter policy indicates that an update should be performed). This is useful when the
-        /// process that the \ref update_filter is reponding to completes and the finalised data
-        /// need to be actioned.
+        /// process that the \ref basic_update_filter is reponding to completes and the finalised
+        /// data need to be actioned.
         ///
 
         void sync(const value_ts&... new_values) {
-            m_update(new_values...);
-            m_last_values = std::make_tuple(new_values...);
+            this->count_sync();
+            this->invoke_timed([&] { this->invoke_callback(m_update, new_values...); });
+            store_last_values(std::tie(new_values...));
+            this->notify_policy();
+        }
+
+        template <typename... arg_ts, typename = std::enable_if_t<are_values_v<arg_ts...>>>
+        void sync(arg_ts&&... new_values) {
+            this->count_sync();
+            this->invoke_timed([&] { this->invoke_callback(m_update, std::as_const(new_values)...); });
+            store_last_values(std::forward_as_tuple(std::move(new_values)...));
+            this->notify_policy();
         }
 
         ///
-        /// Compares \p new_values with the last actioned data stored within the \ref update_filter.
-        /// If the filter policy indicates that these new data are sufficiently different to the
-        /// last actioned data, the callback function passed to the constructor of this
-        /// \ref update_filter instance is invoked for \p new_values and these new values replace
-        /// the last actioned data within the \ref update_filter; otherwise, no action is taken.
-        /// Policies should ensure that an update is always performed the first time this member
-        /// function is called.
+        /// Compares \p new_values with the last actioned data stored within the
+        /// \ref basic_update_filter. If the filter policy indicates that these new data are
+        /// sufficiently different to the last actioned data, the callback function passed to the
+        /// constructor of this \ref basic_update_filter instance is invoked for \p new_values and
+        /// these new values replace the last actioned data within the \ref basic_update_filter;
+        /// otherwise, no action is taken. Policies should ensure that an update is always performed
+        /// the first time this member function is called.
+        ///
+        /// The policy compares references to the arguments, so a rejected update copies nothing.
+        /// An accepted update copies the arguments into the filter, except when every argument is
+        /// an rvalue of the corresponding type in \p value_ts, in which case they are moved.
         ///
 
         auto update(const value_ts&... new_values) -> bool {
 
-            auto new_tuple = std::make_tuple(new_values...);
-            const auto needs_update = policy_t::can_update(m_last_values, new_tuple);
+            const auto needs_update = policy_t::can_update(this->m_last_values, std::tie(new_values...));
+            this->count_update(needs_update);
 
             if (needs_update) {
-                m_update(new_values...);
-                m_last_values = std::move(new_tuple);
+                this->invoke_timed([&] { this->invoke_callback(m_update, new_values...); });
+                store_last_values(std::tie(new_values...));
+                this->notify_policy();
             }
 
             return needs_update;
         }
 
+        template <typename... arg_ts, typename = std::enable_if_t<are_values_v<arg_ts...>>>
+        auto update(arg_ts&&... new_values) -> bool {
+
+            const auto needs_update =
+                policy_t::can_update(this->m_last_values, std::tie(std::as_const(new_values)...));
+            this->count_update(needs_update);
+
+            if (needs_update) {
+                this->invoke_timed([&] { this->invoke_callback(m_update, std::as_const(new_values)...); });
+                store_last_values(std::forward_as_tuple(std::move(new_values)...));
+                this->notify_policy();
+            }
+
+            return needs_update;
+        }
+
+        ///
+        /// Returns a copy of the last-actioned data. For a filter with snapshot reads (see
+        /// filter_policy::snapshot), this may be called on any thread, concurrently with update()
+        /// and sync() on another, and returns data that were all actioned together: the copy is
+        /// retried if the data were replaced meanwhile, without ever blocking the writer.
+
+        auto snapshot() const -> std::tuple<value_ts...> {
+
+            if constexpr (snapshot_reads) {
+                return this->read();
+            } else {
+                return this->m_last_values;
+            }
+        }
+
     private:
 
-        update_fn m_update;
-        std::tuple<value_ts...> m_last_values;
+        // With snapshot reads, replacing the data also publishes a copy of them through the
+        // seqlock, which costs more than the two stores to the sequence number alone: the data
+        // are also packed into words, each of which is stored atomically.
+
+        template <typename tuple_t>
+        void store_last_values(tuple_t&& values) {
+
+            this->m_last_values = std::forward<tuple_t>(values);
+            if constexpr (snapshot_reads) {
+                this->publish(this->m_last_values);
+            }
+        }
+
+        callback_t m_update;
     };
 
+    template <template <typename...> class policy, typename... value_ts, typename callback_t>
+    basic_update_filter(update_filter_tag<policy, value_ts...>, callback_t)
+        -> basic_update_filter<policy, callback_t, value_ts...>;
+
+    template <
+        template <typename...> class policy, typename... value_ts,
+        typename t, typename callback_t
+    >
+    basic_update_filter(update_filter_tag<policy, value_ts...>, const t&, callback_t)
+        -> basic_update_filter<policy, callback_t, value_ts...>;
+
+    template <template <typename...> class policy, typename... value_ts>
+    using update_filter = basic_update_filter<policy, std::function<void(value_ts...)>, value_ts...>;
+
+    template <template <typename...> class policy, typename... value_ts>
+    using inplace_update_filter =
+        basic_update_filter<policy, inplace_function<void(value_ts...)>, value_ts...>;
+
     template <std::size_t index, typename t>
     decltype(auto) get(const t& self) {
+        using detail::adl_get;
         return adl_get<index>(self);
     }
 
+    namespace detail {
+
+        ///
+        /// Finds the smallest count whose integer fraction of \p total (as per ksr::int_fraction())
+        /// exceeds \p fraction. The estimate from floating-point arithmetic is corrected against
+        /// ksr::int_fraction() itself, so that threshold comparisons make exactly the same
+        /// decisions as comparisons of fractions. Returns an empty optional for non-positive
+        /// totals and for thresholds that \p count_t cannot represent.
+        ///
+
+        template <int scale, typename count_t, typename = std::enable_if_t<std::is_integral_v<count_t>>>
+        auto fraction_threshold(const int fraction, const count_t total) -> std::optional<count_t> {
+
+            using limits = std::numeric_limits<count_t>;
+
+            if (!(total > count_t{})) {
+                return std::nullopt;
+            }
+
+            const auto estimate = std::ceil(
+                (static_cast<long double>(fraction) + 0.5L) *
+                static_cast<long double>(total) / static_cast<long double>(scale));
+
+            if (estimate >= static_cast<long double>(limits::max()) - 1 ||
+                estimate <= static_cast<long double>(limits::min()) + 1) {
+                return std::nullopt;
+            }
+
+            auto next = static_cast<count_t>(estimate);
+            while (ksr::int_fraction<scale>(next, total) <= fraction) {
+                ++next;
+            }
+            while (ksr::int_fraction<scale>(count_t(next - 1), total) > fraction) {
+                --next;
+            }
+
+            return next;
+        }
+
+        ///
+        /// Finds the smallest count greater than \p count whose integer fraction of \p total
+        /// exceeds that of \p count, as per fraction_threshold().
+        ///
+
+        template <int scale, typename count_t, typename = std::enable_if_t<std::is_integral_v<count_t>>>
+        auto next_fraction_count(const count_t count, const count_t total) -> std::optional<count_t> {
+
+            if (!(total > count_t{})) {
+                return std::nullopt;
+            }
+
+            return fraction_threshold<scale>(ksr::int_fraction<scale>(count, total), total);
+        }
+    }
+
+    ///
+    /// The tolerance of filter_policy::delta: the absolute change of any element, plus the given
+    /// fraction of its magnitude, above which a change is significant.
+    ///
+
+    struct delta_threshold {
+        double absolute = 0.0;
+        double relative = 0.0;
+    };
+
     namespace filter_policy {
 
         ///
@@ -140,110 +551,598 @@ namespace ksr {
         /// elapsed since the last such actioned update. The update interval may be specified upon
         /// construction. Applicable to \ref update_filter instantiations storing arbitrary data.
         ///
+        /// Time is measured by \p chrono_clock_t, which must meet the standard \c Clock
+        /// requirements, except that now() may be a non-static member function (as for
+        /// ksr::every_nth_clock); each policy object owns its own clock object. The clock is read
+        /// at most once per call to can_update(), and not at all for updates that leave the data
+        /// unchanged; sync() (and updates accepted by another policy combined with this one) read
+        /// it once more, to restart the interval. The \ref sampled alias uses \c std::chrono::steady_clock; ksr/clock.hpp
+        /// provides cheaper alternatives, and ksr::manual_clock for tests.
+        ///
 
-        template <typename... value_ts>
-        class sampled {
-        protected:
+        template <typename chrono_clock_t>
+        struct basic_sampled {
 
-            explicit sampled(const std::chrono::milliseconds interval)
-              : m_interval{interval} {}
+            template <typename... value_ts>
+            class policy {
+            public:
 
-            ///
-            /// Determines whether the elapsed time since the last actioned update is greater than
-            /// the duration that this policy object was constructed with (and indicates that an
-            /// update should be actioned if so).
-            ///
+                static constexpr auto evaluation_cost = 10;
 
-            auto can_update(
-                const std::tuple<value_ts...> &current_values,
-                const std::tuple<value_ts...> &new_values) const -> bool {
+            protected:
 
-                if (current_values == new_values) {
-                    return false;
-                }
+                explicit policy(const std::chrono::milliseconds interval)
+                  : m_interval{std::chrono::ceil<typename chrono_clock_t::duration>(interval)} {}
+
+                ///
+                /// Determines whether the elapsed time since the last actioned update is at least
+                /// the duration that this policy object was constructed with (and indicates that an
+                /// update should be actioned if so).
+                ///
+
+                auto can_update(
+                    const std::tuple<value_ts...> &current_values,
+                    const std::tuple<const value_ts&...> &new_values) const -> bool {
 
-                const auto now = std::chrono::steady_clock::now();
-                const auto elapsed = now - m_last_update_time;
+                    m_accepted_time = time_point::min();
 
-                // If this is the first time needs_update() has been called, m_last_update_time will
-                // be set to the epoch of std::chrono::steady_clock, so in the absence of perverse
-                // interval choices, the elapsed time will be large enough to ensure that an update
-                // is triggered.
+                    if (current_values == new_values) {
+                        return false;
+                    }
 
-                if (elapsed >= m_interval) {
-                    m_last_update_time = std::chrono::steady_clock::now();
+                    // Before the first update, m_next_update_time is the earliest representable
+                    // time, so an update is always triggered whatever the clock's epoch.
+
+                    const auto now = m_clock.now();
+                    if (now < m_next_update_time) {
+                        return false;
+                    }
+
+                    m_accepted_time = now;
                     return true;
                 }
 
-                return false;
-            }
+                ///
+                /// Restarts the interval from the time of the actioned update. The interval is
+                /// only restarted here, rather than in can_update(), so that the policy can be
+                /// combined with others (see filter_policy::all_of) which may yet reject the
+                /// update; the time read by can_update() is reused where it accepted the update,
+                /// and the clock is read afresh otherwise (e.g. for sync()).
+                ///
 
-        private:
+                void on_update(const std::tuple<value_ts...>&) {
+                    const auto now = m_accepted_time != time_point::min() ? m_accepted_time : m_clock.now();
+                    m_next_update_time = now + m_interval;
+                    m_accepted_time = time_point::min();
+                }
+
+                ///
+                /// Forgets the time read by can_update() when a combinator rejects the update that
+                /// this policy accepted, so that a later sync() doesn't restart the interval from it.
+                ///
+
+                void on_reject() const {
+                    m_accepted_time = time_point::min();
+                }
+
+            private:
+
+                using time_point = typename chrono_clock_t::time_point;
 
-            std::chrono::milliseconds m_interval;
-            mutable std::chrono::steady_clock::time_point m_last_update_time;
+                typename chrono_clock_t::duration m_interval;
+                mutable chrono_clock_t m_clock;
+                time_point m_next_update_time = time_point::min();
+                mutable time_point m_accepted_time = time_point::min();
+            };
         };
 
+        template <typename... value_ts>
+        using sampled = typename basic_sampled<std::chrono::steady_clock>::template policy<value_ts...>;
+
         ///
         /// Policy class for an \ref update_filter tracking two arithmetic values that accepts
-        /// updates when the integer percentage that those two data specify (when interpreted as the
-        /// numerator and denominator of a quotient) changes. Only applicable to the
-        /// \ref update_filter instantiation storing a pair of \p num_t values.
-        ///
-
-        template <
-            typename count_t,
-            typename total_t,
-            typename = std::enable_if_t<
-                std::is_same_v<count_t, total_t> &&
-                std::is_arithmetic_v<count_t>>
-        >
-        class int_percentage {
-        private:
+        /// updates when the integer fraction that those two data specify (when interpreted as the
+        /// numerator and denominator of a quotient, and scaled by \p scale) changes. Only
+        /// applicable to the \ref update_filter instantiation storing a pair of \p num_t values.
+        /// The \ref int_percentage, \ref int_per_mille and \ref int_basis_points aliases provide
+        /// the common resolutions.
+        ///
+        /// For integral \p count_t, the policy precomputes the smallest count that would raise the
+        /// fraction above that of the last-actioned data. While the total remains unchanged, each
+        /// call to can_update() is then a single integer comparison against that threshold, however
+        /// fine the resolution; the threshold is only recomputed when an update is actioned or the
+        /// total changes (and stays changed for a second call). (The fast path is disabled for
+        /// non-positive totals and for unrepresentable thresholds.)
+        ///
+
+        template <int scale_v>
+        struct int_fraction {
+
+            static_assert(scale_v > 0);
+
+            template <
+                typename count_t,
+                typename total_t,
+                typename = std::enable_if_t<
+                    std::is_same_v<count_t, total_t> &&
+                    std::is_arithmetic_v<count_t>>
+            >
+            class policy {
+            private:
+
+                using filter_t = detail::update_filter_state<policy, count_t, total_t>;
+
+            public:
+
+                static constexpr auto scale = scale_v;
+                static constexpr auto evaluation_cost = std::is_integral_v<count_t> ? 1 : 3;
+                static constexpr auto accesses_filter_state = true;
+
+                ///
+                /// The last-actioned data. As they are read from the filter, which is only of the
+                /// expected type when the policy is used alone, these accessors are hidden when the
+                /// policy is combined with others (see filter_policy::all_of), for which
+                /// ksr::get() must be used.
+                ///
+
+                count_t count() const {
+                    return ksr::get<0>(static_cast<const filter_t&>(*this));
+                }
+
+                total_t total() const {
+                    return ksr::get<1>(static_cast<const filter_t&>(*this));
+                }
+
+            protected:
+
+                ///
+                /// Determines whether the integer fraction formed by \p new_values (when
+                /// interpreted as the numerator and denominator of a quotient) is greater than that
+                /// formed by \p old_values (and indicates that an update should be actioned if so).
+                ///
+
+                auto can_update(
+                    const std::tuple<count_t, total_t>& old_values,
+                    const std::tuple<const count_t&, const total_t&>& new_values) const -> bool {
+
+                    const auto& [old_count, old_total] = old_values;
+                    const auto& [new_count, new_total] = new_values;
+
+                    if (old_total == 0) {
+                        return true;
+                    }
 
-            using filter_t = update_filter<int_percentage, count_t, total_t>;
+                    // A zero m_threshold_total means that no threshold is cached (thresholds are
+                    // only cached for positive totals), so must not match a zero new_total.
+                    //
+                    // Once a new total has been passed twice in a row, the threshold of the
+                    // last-actioned fraction is recomputed for it, so that later calls with that
+                    // total take the fast path too. (Recomputing it on the first call would cost
+                    // more than the slow path where the total changes on every call.)
 
+                    if constexpr (std::is_integral_v<count_t>) {
+
+                        if (new_total != m_threshold_total) {
+                            if (new_total == m_pending_total) {
+                                cache_threshold(ksr::int_fraction<scale>(old_count, old_total), new_total);
+                            } else {
+                                m_pending_total = new_total;
+                            }
+                        }
+
+                        if (m_threshold_total != total_t{} && new_total == m_threshold_total) {
+                            return new_count >= m_next_count;
+                        }
+                    }
+
+                    const auto old_fraction = ksr::int_fraction<scale>(old_count, old_total);
+                    const auto new_fraction = ksr::int_fraction<scale>(new_count, new_total);
+                    return new_fraction > old_fraction;
+                }
+
+                void on_update(const std::tuple<count_t, total_t>& values) {
+                    if constexpr (std::is_integral_v<count_t>) {
+                        const auto& [count, total] = values;
+                        if (total > total_t{}) {
+                            cache_threshold(ksr::int_fraction<scale>(count, total), total);
+                        } else {
+                            m_threshold_total = total_t{};
+                        }
+                    }
+                }
+
+            private:
+
+                void cache_threshold(const int fraction, const total_t total) const {
+
+                    if (const auto next = detail::fraction_threshold<scale>(fraction, total)) {
+                        m_next_count = *next;
+                        m_threshold_total = total;
+                    } else {
+                        m_threshold_total = total_t{};
+                    }
+                }
+
+                mutable count_t m_next_count = count_t{};
+                mutable total_t m_threshold_total = total_t{};
+                mutable total_t m_pending_total = total_t{};
+            };
+        };
+
+        template <typename count_t, typename total_t>
+        using int_percentage = typename int_fraction<100>::template policy<count_t, total_t>;
+
+        template <typename count_t, typename total_t>
+        using int_per_mille = typename int_fraction<1000>::template policy<count_t, total_t>;
+
+        template <typename count_t, typename total_t>
+        using int_basis_points = typename int_fraction<10000>::template policy<count_t, total_t>;
+
+        ///
+        /// The smoothed throughput, in items per second (or zero, until it has been measured),
+        /// and the estimated time remaining (or an empty optional, until the throughput has been
+        /// measured) of a job filtered by \ref basic_adaptive_rate, as passed to callbacks that
+        /// take it after the count and total.
+        ///
+
+        struct rate_estimate {
+            double throughput = 0.0;
+            std::optional<std::chrono::duration<double>> eta;
+        };
+
+        ///
+        /// Policy class for an \ref update_filter tracking a count of items processed and their
+        /// total that aims for a steady rate of notifications, whatever the rate at which items
+        /// are processed: roughly one per interval given on construction (e.g. 100ms for ten
+        /// notifications per second), for a ten-second job and a ten-hour job alike. Only
+        /// applicable to the \ref update_filter instantiation storing a pair of integral
+        /// \p count_t values.
+        ///
+        /// The policy keeps an exponentially weighted moving average of the item throughput, from
+        /// which it predicts the count that will be reached one interval after each actioned
+        /// update. Until that count is reached, each call to can_update() is a single integer
+        /// comparison, so the cost per update stays constant however fast items arrive; the clock
+        /// is only read when the predicted count is reached (about once per interval), and the
+        /// prediction is corrected from the measured time if it was reached too early. The first
+        /// update, updates that change the total and the update that completes the job (i.e. that
+        /// reaches the total) skip the comparison, and the last is always accepted.
+        ///
+        /// The throughput and the estimated time remaining are available from throughput() and
+        /// eta(). Both are brought up to date before the callback is invoked, and a callback that
+        /// takes a \ref rate_estimate after the count and total is given them (which, as the
+        /// \ref update_filter aliases' callbacks take only the data, needs an
+        /// \ref update_filter_tag), e.g.
+        /// ```c++
+        /// auto filter = basic_update_filter{
+        ///     update_filter_tag<filter_policy::adaptive_rate, std::int64_t, std::int64_t>{}, 100ms,
+        ///     [&](std::int64_t count, std::int64_t total, const filter_policy::rate_estimate& rate) { ... }};
+        /// ```
+        ///
+        /// Time is measured by \p chrono_clock_t, as for basic_sampled.
+        ///
+
+        template <typename chrono_clock_t>
+        struct basic_adaptive_rate {
+
+            template <
+                typename count_t,
+                typename total_t,
+                typename = std::enable_if_t<
+                    std::is_same_v<count_t, total_t> &&
+                    std::is_integral_v<count_t>>
+            >
+            class policy {
+            private:
+
+                using duration = typename chrono_clock_t::duration;
+                using time_point = typename chrono_clock_t::time_point;
+
+            public:
+
+                using seconds = std::chrono::duration<double>;
+
+                static constexpr auto evaluation_cost = 1;
+
+                ///
+                /// The weight given to each new throughput measurement in the moving average.
+                ///
+
+                static constexpr auto smoothing = 0.25;
+
+                ///
+                /// The smoothed throughput, in items per second (or zero, until it has been
+                /// measured).
+                ///
+
+                auto throughput() const -> double {
+                    return m_throughput;
+                }
+
+                ///
+                /// The estimated time remaining until the job completes, at the smoothed
+                /// throughput (or an empty optional, until that has been measured). The estimate
+                /// is for the count and total at which the throughput was last measured; from the
+                /// callback, those of the update being actioned.
+                ///
+
+                auto eta() const -> std::optional<seconds> {
+
+                    if (!(m_throughput > 0)) {
+                        return std::nullopt;
+                    }
+
+                    const auto remaining = m_measured_total > m_measured_count
+                        ? static_cast<double>(m_measured_total - m_measured_count) : 0.0;
+                    return seconds{remaining / m_throughput};
+                }
+
+            protected:
+
+                explicit policy(const std::chrono::milliseconds interval)
+                  : m_interval{std::chrono::ceil<duration>(interval)} {}
+
+                auto callback_state() const -> rate_estimate {
+                    return {throughput(), eta()};
+                }
+
+                ///
+                /// Determines whether \p new_values have reached the count predicted for the end
+                /// of the current interval, and if so, whether enough of the interval has actually
+                /// elapsed (and indicates that an update should be actioned if so). Where the
+                /// prediction was reached too early, it is raised by the number of items expected
+                /// in the remainder of the interval.
+                ///
+
+                auto can_update(
+                    const std::tuple<count_t, total_t>& old_values,
+                    const std::tuple<const count_t&, const total_t&>& new_values) const -> bool {
+
+                    const auto& [old_count, old_total] = old_values;
+                    const auto& [new_count, new_total] = new_values;
+
+                    m_accepted_time = time_point::min();
+
+                    const auto completes = new_count >= new_total && old_count < old_total;
+                    if (new_total == old_total && new_count < m_next_count && !completes) {
+                        return false;
+                    }
+
+                    const auto now = m_clock.now();
+                    measure(new_count, new_total, now);
+
+                    // Before the first update, m_last_update_time is the earliest representable
+                    // time, so the first update is always accepted. Otherwise, half an interval
+                    // is enough: a prediction that is reached that late is a prediction that is
+                    // roughly right.
+
+                    if (!completes && now < m_last_update_time + m_interval / 2) {
+                        m_next_count = advance(new_count, m_interval - (now - m_last_update_time));
+                        return false;
+                    }
+
+                    m_accepted_time = now;
+                    return true;
+                }
+
+                ///
+                /// Predicts the count for the end of the interval starting with the actioned
+                /// update. As for basic_sampled, the time read by can_update() is reused where it
+                /// accepted the update, and the clock is read afresh otherwise (e.g. for sync()).
+                ///
+
+                void on_update(const std::tuple<count_t, total_t>& values) {
+
+                    const auto& [count, total] = values;
+
+                    if (m_accepted_time != time_point::min()) {
+                        m_last_update_time = m_accepted_time;
+                    } else {
+                        m_last_update_time = m_clock.now();
+                        measure(count, total, m_last_update_time);
+                    }
+
+                    m_next_count = advance(count, m_interval);
+                    m_accepted_time = time_point::min();
+                }
+
+            private:
+
+                using limits = std::numeric_limits<count_t>;
+
+                ///
+                /// Folds the throughput since the previous measurement into the moving average.
+                /// Measurements over no time at all (e.g. within one tick of a coarse clock) are
+                /// deferred, and a count that has gone backwards restarts the measurements.
+                ///
+
+                void measure(const count_t count, const total_t total, const time_point now) const {
+
+                    m_measured_count = count;
+                    m_measured_total = total;
+
+                    if (m_sample_time == time_point::min() || count < m_sample_count) {
+                        m_sample_time = now;
+                        m_sample_count = count;
+                        return;
+                    }
+
+                    const auto elapsed = std::chrono::duration_cast<seconds>(now - m_sample_time).count();
+                    if (!(elapsed > 0)) {
+                        return;
+                    }
+
+                    const auto rate = static_cast<double>(count - m_sample_count) / elapsed;
+                    m_throughput = m_throughput > 0 ? m_throughput + smoothing * (rate - m_throughput) : rate;
+                    m_sample_time = now;
+                    m_sample_count = count;
+                }
+
+                ///
+                /// The count expected to be reached \p time after reaching \p count. Until the
+                /// throughput has been measured, the step grows geometrically instead, so that a
+                /// fast producer doesn't read the clock on every update while waiting for it to
+                /// tick.
+                ///
+
+                auto advance(const count_t count, const duration time) const -> count_t {
+
+                    const auto items = m_throughput > 0
+                        ? m_throughput * std::chrono::duration_cast<seconds>(time).count()
+                        : static_cast<double>(count - m_sample_count);
+
+                    const auto headroom = static_cast<double>(limits::max()) - static_cast<double>(count);
+                    if (!(items < headroom)) {
+                        return limits::max();
+                    }
+
+                    return static_cast<count_t>(count + std::max(count_t{1}, static_cast<count_t>(items)));
+                }
+
+                duration m_interval;
+                mutable chrono_clock_t m_clock;
+                time_point m_last_update_time = time_point::min();
+                mutable time_point m_accepted_time = time_point::min();
+                mutable count_t m_next_count = limits::lowest();
+
+                mutable time_point m_sample_time = time_point::min();
+                mutable count_t m_sample_count = count_t{};
+                mutable double m_throughput = 0.0;
+                mutable count_t m_measured_count = count_t{};
+                mutable total_t m_measured_total = total_t{};
+            };
+        };
+
+        template <typename count_t, typename total_t>
+        using adaptive_rate = typename basic_adaptive_rate<std::chrono::steady_clock>::template policy<count_t, total_t>;
+
+        ///
+        /// Policy class for an \ref update_filter storing arithmetic data that accepts updates
+        /// when any element of the data has moved from its last-actioned value by more than a
+        /// tolerance, given on construction as a \ref ksr::delta_threshold: a change \c d of an
+        /// element whose last-actioned value is \c v is significant if
+        /// <tt>|d| > absolute + relative * |v|</tt>. (So a relative threshold alone ignores changes
+        /// from zero only if they are zero, and an absolute threshold alone ignores changes of at
+        /// most that size.) Changes involving NaN are not significant.
+        ///
+        /// Rather than folding over the tuples element by element, the policy copies both into
+        /// arrays of a common lane type (\c float if all elements are \c float, \c double
+        /// otherwise), and compares them in a single branch-free loop that the compiler turns into
+        /// a few SIMD instructions for typical tuple sizes.
+        ///
+
+        template <typename... value_ts>
+        class delta {
         public:
 
-            count_t count() const {
-                return ksr::get<0>(static_cast<const filter_t&>(*this));
-            }
+            static_assert(sizeof...(value_ts) > 0);
+            static_assert(std::conjunction_v<std::is_arithmetic<value_ts>...>,
+                "the delta policy is only applicable to arithmetic data");
 
-            total_t total() const {
-                return ksr::get<1>(static_cast<const filter_t&>(*this));
-            }
+            static constexpr auto evaluation_cost = 2;
 
         protected:
 
+            explicit delta(const delta_threshold& threshold)
+              : m_absolute{static_cast<lane_t>(threshold.absolute)},
+                m_relative{static_cast<lane_t>(threshold.relative)} {}
+
             ///
-            /// Determines whether the integer percentage formed by \p old_values (when interpreted
-            /// as the numerator and denominator of a quotient) is greater than that formed by
-            /// \p new_values (and indicates that an update should be actioned if so).
+            /// Determines whether any element of \p new_values differs from that of
+            /// \p current_values by more than the tolerance (and indicates that an update should
+            /// be actioned if so).
             ///
 
             auto can_update(
-                const std::tuple<count_t, total_t>& old_values,
-                const std::tuple<count_t, total_t>& new_values) const -> bool {
+                const std::tuple<value_ts...>& current_values,
+                const std::tuple<const value_ts&...>& new_values) const -> bool {
 
-                const auto& [old_count, old_total] = old_values;
-                const auto& [new_count, new_total] = new_values;
+                const auto current = to_lanes(current_values);
+                const auto next = to_lanes(new_values);
 
-                if (old_total == 0) {
-                    return true;
+                // The comparisons are accumulated as masks of the lane width, rather than as a
+                // bool, as compilers only vectorise the reduction in that form.
+
+                auto significant = mask_t{0};
+                for (auto i = std::size_t{0}; i < lane_count; ++i) {
+                    significant |= -static_cast<mask_t>(
+                        std::abs(next[i] - current[i]) > m_absolute + m_relative * std::abs(current[i]));
                 }
 
-                const auto old_percentage = ksr::int_percentage(old_count, old_total);
-                const auto new_percentage = ksr::int_percentage(new_count, new_total);
-                return new_percentage > old_percentage;
+                return significant != 0;
             }
+
+        private:
+
+            using lane_t = std::conditional_t<std::conjunction_v<std::is_same<value_ts, float>...>, float, double>;
+            using mask_t = std::conditional_t<sizeof(lane_t) == 4, std::int32_t, std::int64_t>;
+            static constexpr auto lane_count = sizeof...(value_ts);
+
+            template <typename tuple_t>
+            static auto to_lanes(const tuple_t& values) -> std::array<lane_t, lane_count> {
+                return std::apply([](const auto&... elements) {
+                    return std::array<lane_t, lane_count>{static_cast<lane_t>(elements)...};
+                }, values);
+            }
+
+            lane_t m_absolute;
+            lane_t m_relative;
+        };
+
+        ///
+        /// Wraps \p inner_policy to select a mode of \ref basic_update_filter in which the
+        /// last-actioned data are guarded by a seqlock, so that other threads (e.g. a UI thread)
+        /// may read them via snapshot(), ksr::get() or a decomposition declaration while the
+        /// filter is being updated, without blocking the thread updating it. Updates are filtered
+        /// exactly as by \p inner_policy (which is constructed from the same policy data); each
+        /// accepted update then also copies the data into atomic words for readers, costing a
+        /// store per 8 bytes of data and two to the sequence number. The data must be trivially
+        /// copyable.
+        ///
+        /// snapshot() returns all of the data from a single update, whereas ksr::get() reads one
+        /// element at a time (so a decomposition declaration may mix elements from different
+        /// updates; decompose the result of snapshot() instead). The wrapper selects the mode of
+        /// the filter itself, so it must be the outermost policy: it cannot be combined by
+        /// filter_policy::all_of and the like.
+        ///
+
+        template <template <typename...> class inner_policy>
+        struct snapshot {
+
+            template <typename... value_ts>
+            struct policy {
+                using snapshot_inner_type = inner_policy<value_ts...>;
+            };
         };
     }
 
     template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
     using int_percentage_filter = update_filter<filter_policy::int_percentage, num_t, num_t>;
 
+    template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
+    using int_per_mille_filter = update_filter<filter_policy::int_per_mille, num_t, num_t>;
+
+    template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
+    using int_basis_points_filter = update_filter<filter_policy::int_basis_points, num_t, num_t>;
+
     template <typename... value_ts>
     using sampled_filter = update_filter<filter_policy::sampled, value_ts...>;
+
+    template <typename chrono_clock_t, typename... value_ts>
+    using basic_sampled_filter =
+        update_filter<filter_policy::basic_sampled<chrono_clock_t>::template policy, value_ts...>;
+
+    template <typename num_t, typename = std::enable_if_t<std::is_integral_v<num_t>>>
+    using adaptive_rate_filter = update_filter<filter_policy::adaptive_rate, num_t, num_t>;
+
+    template <typename chrono_clock_t, typename num_t, typename = std::enable_if_t<std::is_integral_v<num_t>>>
+    using basic_adaptive_rate_filter =
+        update_filter<filter_policy::basic_adaptive_rate<chrono_clock_t>::template policy, num_t, num_t>;
+
+    template <typename... value_ts>
+    using delta_filter = update_filter<filter_policy::delta, value_ts...>;
+
+    template <template <typename...> class policy, typename... value_ts>
+    using snapshot_update_filter = update_filter<filter_policy::snapshot<policy>::template policy, value_ts...>;
 }
 
 // It looks like this is weirdness in the development version of libstdc++, in whose <utility>
@@ -260,13 +1159,17 @@ namespace std {
     // These two specialisations allow an update_filter to be decomposed in the same way that would
     // be permitted for the tuple of data that it stores.
 
-    template<std::size_t index, template <typename...> class policy_t, typename... value_ts>
-    struct tuple_element<index, ksr::update_filter<policy_t, value_ts...>> {
-        using type = decltype(ksr::get<index>(std::declval<ksr::update_filter<policy_t, value_ts...>>()));
+    template <
+        std::size_t index,
+        template <typename...> class policy_t, typename callback_t, typename... value_ts
+    >
+    struct tuple_element<index, ksr::basic_update_filter<policy_t, callback_t, value_ts...>> {
+        using type = decltype(ksr::get<index>(
+            std::declval<ksr::basic_update_filter<policy_t, callback_t, value_ts...>>()));
     };
 
-    template <template <typename...> class policy_t, typename... value_ts>
-    struct tuple_size<ksr::update_filter<policy_t, value_ts...>>
+    template <template <typename...> class policy_t, typename callback_t, typename... value_ts>
+    struct tuple_size<ksr::basic_update_filter<policy_t, callback_t, value_ts...>>
         : public std::integral_constant<std::size_t, sizeof...(value_ts)> {};
 }
 
@@ -276,11 +1179,31 @@ namespace std {
 
 namespace ksr {
 
-    template <typename num_t, typename = std::enable_if_t<std::is_arithmetic_v<num_t>>>
-    int int_percentage(const int_percentage_filter<num_t>& filter) {
+    template <
+        typename callback_t, typename num_t,
+        typename = std::enable_if_t<std::is_arithmetic_v<num_t>>
+    >
+    int int_percentage(
+        const basic_update_filter<filter_policy::int_percentage, callback_t, num_t, num_t>& filter) {
         const auto& [num, denom] = filter;
         return int_percentage(num, denom);
     }
+
+    ///
+    /// Gets the integer fraction of the last-actioned data of \p filter at the resolution of that
+    /// filter's policy (for example, in basis points for an \ref int_basis_points_filter).
+    ///
+
+    template <
+        template <typename...> class policy, typename callback_t, typename num_t,
+        typename = std::enable_if_t<std::is_arithmetic_v<num_t>>
+    >
+    auto int_fraction(const basic_update_filter<policy, callback_t, num_t, num_t>& filter)
+        -> decltype(policy<num_t, num_t>::scale, int{}) {
+
+        const auto& [num, denom] = filter;
+        return int_fraction<policy<num_t, num_t>::scale>(num, denom);
+    }
 }
 
 #endif
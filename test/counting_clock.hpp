@@ -0,0 +1,26 @@
+#ifndef KSR_TEST_COUNTING_CLOCK_HPP
+#define KSR_TEST_COUNTING_CLOCK_HPP
+
+#include "ksr/clock.hpp"
+
+#include <chrono>
+
+namespace ksr_test {
+
+    // A ksr::manual_clock that counts how often it is read, to check how often policies read
+    // their clocks. It shares the time of manual_clock, but has its own time_point type.
+
+    struct counting_clock : public ksr::manual_clock {
+
+        using time_point = std::chrono::time_point<counting_clock, duration>;
+
+        static auto now() noexcept -> time_point {
+            ++reads;
+            return time_point{ksr::manual_clock::now().time_since_epoch()};
+        }
+
+        inline static auto reads = 0;
+    };
+}
+
+#endif
@@ -2,7 +2,25 @@
 
 #include "catch/catch.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <forward_list>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <list>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -12,6 +30,86 @@ using meta_seq = std::vector<seq>;
 
 namespace {
 
+    // A range whose find() member records that it was used, and which can't be searched
+    // linearly (as its iterators are never dereferenced by find()).
+
+    struct lookup_table {
+
+        auto begin() const -> const int* { return values.data(); }
+        auto end() const -> const int* { return values.data() + values.size(); }
+
+        auto find(const int value) const -> const int* {
+            ++finds;
+            return std::find(begin(), end(), value);
+        }
+
+        std::vector<int> values;
+        mutable int finds = 0;
+    };
+
+    enum class tag : std::uint16_t { none, red = 0x0102, green = 0x0201 };
+
+    // Checks that contains() agrees with std::find() for a needle at each position of ranges of
+    // each length up to a few vectors' worth, for elements of type t.
+
+    template <typename t>
+    auto contains_matches_find() -> bool {
+
+        for (auto size = std::size_t{0}; size < 80; ++size) {
+
+            auto values = std::vector<t>(size, t{1});
+            for (auto position = std::size_t{0}; position <= size; ++position) {
+
+                if (position < size) {
+                    values[position] = t{7};
+                }
+
+                const auto expected = std::find(values.begin(), values.end(), t{7}) != values.end();
+                if (contains(values, t{7}) != expected || contains(values.data(), values.data() + size, t{7}) != expected) {
+                    return false;
+                }
+
+#ifdef KSR_HAS_SIMD_FIND
+                if constexpr (sizeof(t) > 1) {
+                    if ((detail::find_sse2(values.data(), values.data() + size, t{7}) != values.data() + size) != expected) {
+                        return false;
+                    }
+                }
+#endif
+
+                if (position < size) {
+                    values[position] = t{1};
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // The k-permutations of a sorted domain, enumerated by permuting the whole domain.
+
+    auto reference_k_permutations(seq domain, const std::size_t k) -> meta_seq {
+
+        auto result = meta_seq{};
+        do {
+            result.emplace_back(domain.begin(), domain.begin() + static_cast<std::ptrdiff_t>(k));
+            std::reverse(domain.begin() + static_cast<std::ptrdiff_t>(k), domain.end());
+        } while (std::next_permutation(domain.begin(), domain.end()));
+
+        return result;
+    }
+
+    auto has_k_permutations(seq domain, const std::size_t k) -> bool {
+
+        const auto sorted = domain;
+        auto actual = meta_seq{};
+        k_permute(domain, k, [&actual](const auto begin, const auto end) {
+            actual.push_back(seq{begin, end});
+        });
+
+        return actual == reference_k_permutations(sorted, k) && domain == sorted;
+    }
+
     auto has_sub_permutations(seq domain, const meta_seq& expected) -> bool {
 
         auto actual = meta_seq{};
@@ -22,6 +120,128 @@ namespace {
         sub_permute(domain, push_back);
         return actual == expected;
     }
+
+    auto sub_permutations(seq& domain, const sub_permute_order order) -> meta_seq {
+
+        auto actual = meta_seq{};
+        sub_permute(domain, order, [&actual](const auto begin, const auto end) {
+            actual.push_back(seq{begin, end});
+        });
+
+        return actual;
+    }
+}
+
+TEST_CASE("k_permute", "[algorithm]") {
+
+    CHECK(has_k_permutations({}, 0));
+    CHECK(has_k_permutations({0, 1, 2}, 0));
+    CHECK((has_k_permutations({0, 1, 2}, 2)));
+
+    for (const auto& domain : meta_seq{{0, 1, 2, 3, 4}, {0, 0, 1, 1, 1}, {0, 1, 1, 2, 2, 2}, {3, 3, 3}}) {
+        for (auto k = std::size_t{0}; k <= domain.size(); ++k) {
+            CHECK(has_k_permutations(domain, k));
+        }
+    }
+
+    // Bidirectional iterators.
+
+    auto list = std::list<int>{0, 1, 1, 2};
+    auto actual = meta_seq{};
+    k_permute(list, 2, [&actual](const auto begin, const auto end) {
+        actual.push_back(seq{begin, end});
+    });
+
+    CHECK(actual == reference_k_permutations({0, 1, 1, 2}, 2));
+    CHECK((list == std::list<int>{0, 1, 1, 2}));
+}
+
+TEST_CASE("k_permute_rank", "[algorithm]") {
+
+    CHECK(k_permute_count(0, 0) == std::uint64_t{1});
+    CHECK(k_permute_count(5, 2) == std::uint64_t{20});
+    CHECK(k_permute_count(2, 3) == std::uint64_t{0});
+    CHECK(k_permute_count(20, 20) == std::uint64_t{2432902008176640000});
+    CHECK(k_permute_count(21, 21) == std::nullopt);
+    CHECK(k_permute_count(100000, 3) == std::uint64_t{999970000200000});
+
+    // Ranks follow the order of enumeration, and unranking recreates the state in which
+    // k_permute() presents each partial permutation.
+
+    for (auto k = std::size_t{0}; k <= 5; ++k) {
+
+        const auto sorted = seq{1, 3, 5, 7, 9};
+        auto domain = sorted;
+        auto index = std::uint64_t{0};
+        auto consistent = true;
+
+        k_permute(domain, k, [&](const auto begin, const auto end) {
+
+            auto unranked = sorted;
+            k_permute_unrank(unranked, k, index);
+
+            consistent = consistent && k_permute_rank(sorted, seq{begin, end}) == index &&
+                std::equal(begin, end, unranked.begin()) &&
+                std::is_sorted(unranked.begin() + static_cast<std::ptrdiff_t>(k), unranked.end());
+            ++index;
+        });
+
+        CHECK(consistent);
+        CHECK(index == k_permute_count(5, k));
+    }
+
+    // Indices beyond 64 bits, where the count of partial permutations isn't representable.
+
+    auto domain = seq(30);
+    std::iota(domain.begin(), domain.end(), 0);
+    const auto sorted = domain;
+
+    const auto max = std::numeric_limits<std::uint64_t>::max();
+    k_permute_unrank(domain, 30, max);
+    CHECK(k_permute_rank(sorted, domain) == max);
+    CHECK(k_permute_rank(sorted, seq(sorted.rbegin(), sorted.rend())) == std::nullopt);
+    CHECK(k_permute_rank(sorted, seq{29, 28, 27, 26}) == k_permute_count(30, 4).value() - 1);
+
+    auto list = std::list<int>{0, 1, 2, 3};
+    k_permute_unrank(list.begin(), list.end(), 2, 7);
+    CHECK((list == std::list<int>{2, 1, 0, 3}));
+}
+
+TEST_CASE("k_permute_range", "[algorithm]") {
+
+    // Slices, however split, concatenate to the whole enumeration.
+
+    for (const auto k : {std::size_t{0}, std::size_t{3}, std::size_t{6}}) {
+
+        const auto expected = reference_k_permutations({0, 1, 2, 3, 4, 5}, k);
+        const auto count = static_cast<std::uint64_t>(expected.size());
+
+        for (const auto slice : {std::uint64_t{1}, std::uint64_t{7}, std::uint64_t{50}}) {
+
+            auto domain = seq{0, 1, 2, 3, 4, 5};
+            auto actual = meta_seq{};
+            for (auto first = std::uint64_t{0}; first < count + slice; first += slice) {
+                k_permute_range(domain, k, first, first + slice, [&actual](const auto begin, const auto end) {
+                    actual.push_back(seq{begin, end});
+                });
+                CHECK((domain == seq{0, 1, 2, 3, 4, 5}));
+            }
+
+            CHECK(actual == expected);
+        }
+    }
+
+    // The callback may still stop the enumeration.
+
+    auto domain = seq{0, 1, 2, 3};
+    auto actual = meta_seq{};
+    k_permute_range(domain, 2, 3, 10, [&actual](const auto begin, const auto end) {
+        actual.push_back(seq{begin, end});
+        return actual.size() == 2 ? permute_control::stop : permute_control::proceed;
+    });
+
+    CHECK((actual == meta_seq{{1, 0}, {1, 2}}));
+    CHECK((domain == seq{0, 1, 2, 3}));
 }
 
 TEST_CASE("sub_permute", "[algorithm]") {
@@ -39,4 +259,469 @@ TEST_CASE("sub_permute", "[algorithm]") {
 
         CHECK(has_sub_permutations(std::move(domain), expected));
     }
+
+    {
+        auto domain = seq{0, 1, 2};
+        const auto expected = meta_seq{
+            {}, {0}, {0, 1}, {0, 1, 2}, {0, 2}, {0, 2, 1},
+            {1}, {1, 0}, {1, 0, 2}, {1, 2}, {1, 2, 0},
+            {2}, {2, 0}, {2, 0, 1}, {2, 1}, {2, 1, 0}};
+
+        CHECK(sub_permutations(domain, sub_permute_order::prefix_tree) == expected);
+        CHECK((domain == seq{0, 1, 2}));
+    }
+
+    // Both orders enumerate the same partial permutations of multisets, each once; the prefix
+    // tree order is lexicographic.
+
+    for (auto domain : meta_seq{{}, {0, 0}, {0, 1, 1, 2}, {0, 0, 1, 1, 2, 3}, {1, 2, 3, 4, 5}}) {
+
+        const auto sorted = domain;
+        auto by_size = sub_permutations(domain, sub_permute_order::by_size);
+        const auto prefix_tree = sub_permutations(domain, sub_permute_order::prefix_tree);
+
+        CHECK(domain == sorted);
+        CHECK(std::is_sorted(prefix_tree.begin(), prefix_tree.end()));
+        CHECK(std::adjacent_find(prefix_tree.begin(), prefix_tree.end()) == prefix_tree.end());
+
+        std::sort(by_size.begin(), by_size.end());
+        CHECK(by_size == prefix_tree);
+    }
+
+    auto list = std::list<int>{0, 1, 1};
+    auto count = 0;
+    sub_permute(list.begin(), list.end(), sub_permute_order::prefix_tree, [&count](auto, auto) { ++count; });
+    CHECK(count == 9);
+    CHECK((list == std::list<int>{0, 1, 1}));
+}
+
+TEST_CASE("permute_control", "[algorithm]") {
+
+    // Stopping part way leaves the range sorted, whichever way the enumeration was going.
+
+    for (const auto k : {std::size_t{0}, std::size_t{2}, std::size_t{4}}) {
+
+        auto domain = seq{0, 1, 1, 2};
+        auto actual = meta_seq{};
+        k_permute(domain, k, [&actual](const auto begin, const auto end) {
+            actual.push_back(seq{begin, end});
+            return actual.size() == 5 ? permute_control::stop : permute_control::proceed;
+        });
+
+        auto expected = reference_k_permutations({0, 1, 1, 2}, k);
+        expected.resize(std::min(expected.size(), std::size_t{5}));
+        CHECK(actual == expected);
+        CHECK((domain == seq{0, 1, 1, 2}));
+    }
+
+    for (const auto order : {sub_permute_order::by_size, sub_permute_order::prefix_tree}) {
+
+        auto list = std::list<int>{0, 1, 2, 2};
+        auto calls = 0;
+        sub_permute(list, order, [&calls](const auto begin, const auto end) {
+            ++calls;
+            return seq{begin, end} == seq{2, 0, 1} ? permute_control::stop : permute_control::proceed;
+        });
+
+        CHECK(calls == (order == sub_permute_order::by_size ? 18 : 22));
+        CHECK((list == std::list<int>{0, 1, 2, 2}));
+    }
+
+    // Skipping the extensions of a prefix costs only that prefix, in the prefix tree order.
+
+    {
+        auto domain = seq{0, 1, 2, 3};
+        auto actual = meta_seq{};
+        sub_permute(domain, sub_permute_order::prefix_tree, [&actual](const auto begin, const auto end) {
+            actual.push_back(seq{begin, end});
+            return end - begin == 1 && *begin != 2 ? permute_control::skip_extensions : permute_control::proceed;
+        });
+
+        CHECK(actual.size() == 1 + 4 + 3 + 6 + 6);
+        CHECK(std::all_of(actual.begin(), actual.end(), [](const seq& item) { return item.size() < 2 || item[0] == 2; }));
+        CHECK((domain == seq{0, 1, 2, 3}));
+    }
+
+    // A branch-and-bound search for the shortest arrangement of distinct items summing to at
+    // least 12, which needn't extend any arrangement that already does.
+
+    {
+        auto domain = seq{1, 2, 3, 4, 5, 6};
+        auto best = seq{1, 2, 3, 4, 5, 6};
+        auto calls = 0;
+        sub_permute(domain, sub_permute_order::prefix_tree, [&](const auto begin, const auto end) {
+
+            ++calls;
+            const auto size = static_cast<std::size_t>(end - begin);
+            if (size >= best.size()) {
+                return permute_control::skip_extensions;
+            }
+
+            if (std::accumulate(begin, end, 0) >= 12) {
+                best.assign(begin, end);
+                return permute_control::skip_extensions;
+            }
+
+            return permute_control::proceed;
+        });
+
+        // There are 1957 partial permutations of six items in all.
+
+        CHECK((best == seq{1, 5, 6}));
+        CHECK(calls < 1957 / 4);
+    }
+}
+
+TEST_CASE("contains", "[algorithm]") {
+
+    const auto vector = seq{3, 1, 4, 1, 5};
+    CHECK(contains(vector, 4));
+    CHECK_FALSE(contains(vector, 2));
+    CHECK(contains(vector.begin(), vector.end(), 5));
+
+    const auto set = std::set<int>{3, 1, 4};
+    CHECK(contains(set, 3));
+    CHECK_FALSE(contains(set, 5));
+
+    const auto unordered = std::unordered_set<int>{3, 1, 4};
+    CHECK(contains(unordered, 1));
+    CHECK_FALSE(contains(unordered, 2));
+
+    // Maps are searched by key, and heterogeneous lookup is used where the comparator allows it.
+
+    const auto map = std::map<std::string, int, std::less<>>{{"one", 1}, {"two", 2}};
+    CHECK(contains(map, std::string_view{"two"}));
+    CHECK_FALSE(contains(map, std::string_view{"three"}));
+
+    const auto names = std::set<std::string, std::less<>>{"alpha", "beta"};
+    CHECK(contains(names, "beta"));
+    CHECK_FALSE(contains(names, std::string_view{"gamma"}));
+
+    // std::string::find() returns an index, so strings are searched linearly.
+
+    const auto text = std::string{"abc"};
+    CHECK(contains(text, 'b'));
+    CHECK_FALSE(contains(text, 'd'));
+
+    const auto table = lookup_table{{2, 7, 1}};
+    CHECK(contains(table, 7));
+    CHECK_FALSE(contains(table, 8));
+    CHECK(table.finds == 2);
+
+    // A member lookup would convert a needle of another arithmetic type to the key type, so
+    // needles that don't convert exactly are never found, as per std::find().
+
+    CHECK(contains(set, 3.0));
+    CHECK_FALSE(contains(set, 3.5));
+    CHECK_FALSE(contains(set, 1e30));
+    CHECK_FALSE(contains(std::map<int, int>{{1, 1}}, 1.5));
+    CHECK(contains(std::map<int, int>{{1, 1}}, 1.0));
+    CHECK_FALSE(contains(unordered, 4.25));
+    CHECK(contains(unordered, std::int64_t{4}));
+    CHECK_FALSE(contains(unordered, std::int64_t{4} + (std::int64_t{1} << 32)));
+    CHECK_FALSE(contains(std::set<std::uint8_t>{1}, 257));
+    CHECK_FALSE(contains(std::set<float>{1.0f}, 1.0 + 1e-12));
+    CHECK(contains(std::set<std::int64_t>{std::numeric_limits<std::int64_t>::min()}, -0x1p63));
+    CHECK_FALSE(contains(std::set<int, std::less<>>{1}, 1.5));
+    CHECK((contains_each(set, std::vector<double>{1.0, 1.5, 4.0}) == std::vector<bool>{true, false, true}));
+}
+
+TEST_CASE("contains_sorted", "[algorithm]") {
+
+    const auto sorted = seq{1, 3, 5, 7, 9};
+    CHECK(contains_sorted(sorted, 7));
+    CHECK_FALSE(contains_sorted(sorted, 4));
+    CHECK_FALSE(contains_sorted(seq{}, 4));
+
+    const auto descending = seq{9, 7, 5, 3, 1};
+    CHECK(contains_sorted(descending, 3, std::greater<>{}));
+    CHECK_FALSE(contains_sorted(descending.begin(), descending.end(), 4, std::greater<>{}));
+}
+
+TEST_CASE("contains_contiguous", "[algorithm]") {
+
+    CHECK(contains_matches_find<char>());
+    CHECK(contains_matches_find<std::uint8_t>());
+    CHECK(contains_matches_find<std::int16_t>());
+    CHECK(contains_matches_find<std::uint32_t>());
+    CHECK(contains_matches_find<std::int64_t>());
+
+    // Needles of other integral types compare as they would for std::find().
+
+    const auto bytes = std::array<std::uint8_t, 3>{0, 44, 255};
+    CHECK_FALSE(contains(bytes, 300));
+    CHECK_FALSE(contains(bytes, -1));
+    CHECK(contains(bytes, 255L));
+
+    const auto ints = std::vector<std::int32_t>{5, -1};
+    CHECK(contains(ints, std::uint32_t{0xffffffff}));
+    CHECK_FALSE(contains(ints, std::int64_t{0xffffffff}));
+    CHECK(contains(ints, std::int64_t{-1}));
+
+    // Only the exact bit pattern of an enumerator matches.
+
+    const auto tags = std::vector<tag>{tag::none, tag::green, tag::none};
+    CHECK(contains(tags, tag::green));
+    CHECK_FALSE(contains(tags, tag::red));
+
+    const auto raw = "needle";
+    CHECK(contains(raw, raw + 6, 'd'));
+    CHECK_FALSE(contains(raw, raw + 6, 'x'));
+}
+
+namespace {
+
+    // Orderable but not hashable, to exercise the sort-merge strategy.
+
+    struct version {
+        int major;
+        int minor;
+    };
+
+    auto operator<(const version& lhs, const version& rhs) -> bool {
+        return std::tie(lhs.major, lhs.minor) < std::tie(rhs.major, rhs.minor);
+    }
+
+    auto operator==(const version& lhs, const version& rhs) -> bool {
+        return lhs.major == rhs.major && lhs.minor == rhs.minor;
+    }
+
+    // Neither hashable nor orderable.
+
+    struct opaque {
+        int value;
+    };
+
+    auto operator==(const opaque& lhs, const opaque& rhs) -> bool {
+        return lhs.value == rhs.value;
+    }
+}
+
+TEST_CASE("contains_each", "[algorithm]") {
+
+    using flags = std::vector<bool>;
+
+    auto haystack = seq{};
+    for (auto i = 0; i < 1000; ++i) {
+        haystack.push_back(3 * i);
+    }
+
+    // Per-needle scans for a few needles (including duplicates) in a contiguous haystack.
+
+    const auto needles = seq{0, 1, 2997, 2998, 30, 1, 30};
+    CHECK((contains_each(haystack, needles) == flags{true, false, true, false, true, false, true}));
+    CHECK(count_contained(haystack, needles) == 4);
+    CHECK((contains_each(haystack, seq{6, 7}) == flags{true, false}));
+    CHECK(contains_each(haystack, seq{}).empty());
+
+    CHECK(contains_any(haystack, needles));
+    CHECK_FALSE(contains_any(haystack, seq{1, 2, 4, 5, 7}));
+    CHECK_FALSE(contains_all(haystack, needles));
+    CHECK(contains_all(haystack, seq{0, 3, 6, 9, 2997}));
+    CHECK(contains_all(haystack, seq{}));
+
+    // Hashed, with duplicate needles: too many needles to scan for, or a haystack that isn't
+    // contiguous.
+
+    auto many = seq{};
+    auto expected = flags{};
+    for (auto i = 0; i < 100; ++i) {
+        many.push_back(7 * i % 50);
+        expected.push_back(7 * i % 50 % 3 == 0);
+    }
+
+    CHECK(contains_each(haystack, many) == expected);
+    CHECK(count_contained(haystack, many) == 34);
+    CHECK(contains_any(haystack, many));
+    CHECK_FALSE(contains_all(haystack, many));
+
+    const auto list = std::list<int>(haystack.begin(), haystack.end());
+    CHECK((contains_each(list, needles) == flags{true, false, true, false, true, false, true}));
+    CHECK(contains_all(list, seq{2997, 0, 2997}));
+    CHECK_FALSE(contains_all(list, seq{2997, 1}));
+
+    // Hashed by the element type, for needles of another integer type, which never match if
+    // they don't convert exactly.
+
+    const auto wide = std::vector<std::int64_t>(haystack.begin(), haystack.end());
+    CHECK(contains_each(wide, many) == expected);
+
+    const auto bytes = std::deque<std::uint8_t>{0, 3, 255};
+    CHECK((contains_each(bytes, seq{3, 259, -1, 255, 0}) == flags{true, false, false, true, true}));
+    CHECK_FALSE(contains_all(bytes, seq{3, 259}));
+
+    // Member lookup in associative haystacks, stopping at the first needle found by
+    // contains_any(), or the first missing by contains_all().
+
+    const auto set = std::set<int>(haystack.begin(), haystack.end());
+    CHECK((contains_each(set, needles) == flags{true, false, true, false, true, false, true}));
+
+    const auto table = lookup_table{{2, 7, 1}};
+    CHECK_FALSE(contains_all(table, seq{1, 5, 2, 7}));
+    CHECK(table.finds == 2);
+    CHECK(contains_any(table, seq{5, 2, 7}));
+    CHECK(table.finds == 4);
+
+    // Sorted needles for orderable types, in a haystack too big to scan for each, and
+    // per-needle scans for the rest.
+
+    auto versions = std::vector<version>{};
+    for (auto major = 1; major <= 4; ++major) {
+        for (auto minor = 0; minor < 3; ++minor) {
+            versions.push_back({major, minor});
+        }
+    }
+
+    const auto version_needles = std::vector<version>{{3, 1}, {3, 4}, {1, 0}, {5, 0}, {3, 1}, {4, 2}};
+    CHECK((contains_each(versions, version_needles) == flags{true, false, true, false, true, true}));
+    CHECK(count_contained(versions, version_needles) == 4);
+    CHECK(contains_any(versions, version_needles));
+    CHECK_FALSE(contains_all(versions, version_needles));
+    CHECK(contains_all(versions, std::vector<version>{{4, 2}, {1, 1}, {4, 2}}));
+
+    const auto version_list = std::list<version>(versions.begin(), versions.end());
+    CHECK((contains_each(version_list, version_needles) == flags{true, false, true, false, true, true}));
+
+    const auto opaques = std::vector<opaque>{{1}, {2}, {3}, {4}, {5}, {6}};
+    CHECK((contains_each(opaques, std::vector<opaque>{{6}, {7}, {1}, {0}, {2}}) ==
+        flags{true, false, true, false, true}));
+
+    // Merged with the sorted needles: elements that fall back below needles already passed
+    // are still found, whether looked up by hash or (for versions) by binary search.
+
+    const auto sawtooth = std::list<int>{3, 9, 12, 0, 6, 30, 3, 27, 15};
+    const auto sawtooth_needles = seq{0, 15, 1, 27, 30, 3, 31, 6, 29, 9};
+    CHECK((contains_each(sawtooth, sawtooth_needles) ==
+        flags{true, true, false, true, true, true, false, true, false, true}));
+    CHECK(contains_all(sawtooth, seq{30, 15, 0, 12, 6}));
+
+    const auto version_sawtooth = std::list<version>{{2, 0}, {4, 1}, {1, 0}, {3, 2}, {1, 2}};
+    CHECK((contains_each(version_sawtooth, std::vector<version>{{1, 2}, {4, 1}, {1, 1}, {1, 0}, {5, 0}}) ==
+        flags{true, true, false, true, false}));
+
+    // The sorted prefix of a random-access haystack is binary searched for the needles, and the
+    // rest merged.
+
+    auto prefixed = haystack;
+    prefixed.insert(prefixed.end(), {-3, 2, -5, 4});
+
+    auto mixed = many;
+    mixed.insert(mixed.end(), {-5, -4, -3, 2997, 3000});
+    auto mixed_expected = flags{};
+    for (const auto needle : mixed) {
+        mixed_expected.push_back(std::find(prefixed.begin(), prefixed.end(), needle) != prefixed.end());
+    }
+
+    CHECK(contains_each(prefixed, mixed) == mixed_expected);
+    CHECK(contains_each(prefixed, seq(mixed.begin(), mixed.begin() + 40)) ==
+        flags(mixed_expected.begin(), mixed_expected.begin() + 40));
+
+    // Haystacks and needles that can only be traversed once.
+
+    auto stream = std::istringstream{"4 8 15 16 23 42 4"};
+    auto stream_begin = std::istream_iterator<int>{stream};
+    const auto stream_end = std::istream_iterator<int>{};
+    CHECK((contains_each(range_view{stream_begin, stream_end}, std::vector<double>{15.0, 15.5, 42.0, 7.0}) ==
+        flags{true, false, true, false}));
+
+    stream = std::istringstream{"23 16 99 4"};
+    stream_begin = std::istream_iterator<int>{stream};
+    CHECK((contains_each(haystack, range_view{stream_begin, stream_end}) == flags{false, false, true, false}));
+}
+
+namespace {
+
+    // For erasure via a pointer to a member function.
+
+    struct creature {
+
+        auto is_dead() const -> bool { return health == 0; }
+
+        int health;
+    };
+
+    auto operator<(const creature& lhs, const creature& rhs) -> bool {
+        return lhs.health < rhs.health;
+    }
+}
+
+TEST_CASE("erase_if", "[algorithm]") {
+
+    // Qualified, as from C++20, std::erase_if() would be found by ADL for the standard containers.
+
+    const auto is_odd = [](const int value) { return value % 2 != 0; };
+
+    auto vector = seq{1, 2, 3, 4, 5, 6, 7};
+    CHECK(ksr::erase_if(vector, is_odd) == 4);
+    CHECK((vector == seq{2, 4, 6}));
+    CHECK(ksr::erase_if(vector, is_odd) == 0);
+
+    auto deque = std::deque<int>{2, 1, 1, 4};
+    CHECK(ksr::erase_if(deque, is_odd) == 2);
+    CHECK((deque == std::deque<int>{2, 4}));
+
+    auto string = std::string{"a-b--c"};
+    CHECK(ksr::erase_if(string, [](const char c) { return c == '-'; }) == 3);
+    CHECK(string == "abc");
+
+    auto list = std::list<int>{1, 2, 3, 4, 5};
+    CHECK(ksr::erase_if(list, is_odd) == 3);
+    CHECK((list == std::list<int>{2, 4}));
+
+    auto forward_list = std::forward_list<int>{1, 2, 3};
+    CHECK(ksr::erase_if(forward_list, is_odd) == 2);
+    CHECK((forward_list == std::forward_list<int>{2}));
+
+    auto set = std::set<int>{1, 2, 3, 4, 5};
+    CHECK(ksr::erase_if(set, is_odd) == 3);
+    CHECK((set == std::set<int>{2, 4}));
+
+    auto map = std::map<int, int>{{1, 1}, {2, 4}, {3, 9}};
+    CHECK(ksr::erase_if(map, [](const auto& entry) { return entry.second > 3; }) == 2);
+    CHECK((map == std::map<int, int>{{1, 1}}));
+
+    auto creatures = std::vector<creature>{{3}, {0}, {1}, {0}};
+    CHECK(ksr::erase_if(creatures, &creature::is_dead) == 2);
+    CHECK(creatures.size() == 2);
+    CHECK(std::none_of(creatures.begin(), creatures.end(), std::mem_fn(&creature::is_dead)));
+
+    auto creature_list = std::list<creature>{{0}, {2}};
+    CHECK(ksr::erase_if(creature_list, &creature::is_dead) == 1);
+    CHECK(creature_list.size() == 1);
+
+    auto creature_set = std::set<creature>{{0}, {1}, {2}};
+    CHECK(ksr::erase_if(creature_set, &creature::is_dead) == 1);
+    CHECK(creature_set.size() == 2);
+}
+
+TEST_CASE("erase_if_unstable", "[algorithm]") {
+
+    const auto is_odd = [](const int value) { return value % 2 != 0; };
+
+    auto empty = seq{};
+    CHECK(erase_if_unstable(empty, is_odd) == 0);
+
+    auto all = seq{1, 3, 5};
+    CHECK(erase_if_unstable(all, is_odd) == 3);
+    CHECK(all.empty());
+
+    for (auto mask = 0; mask < 1 << 6; ++mask) {
+
+        auto values = seq{};
+        auto expected = seq{};
+        for (auto i = 0; i < 6; ++i) {
+            values.push_back(2 * i + (mask >> i & 1));
+            if (!(mask >> i & 1)) {
+                expected.push_back(2 * i);
+            }
+        }
+
+        CHECK(erase_if_unstable(values, is_odd) == 6 - expected.size());
+        std::sort(values.begin(), values.end());
+        CHECK(values == expected);
+    }
+
+    auto strings = std::deque<std::string>{"x", "keep", "y", "z", "also"};
+    CHECK(erase_if_unstable(strings, [](const std::string& s) { return s.size() == 1; }) == 3);
+    CHECK((strings == std::deque<std::string>{"also", "keep"}));
 }
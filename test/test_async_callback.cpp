@@ -0,0 +1,145 @@
+#include "ksr/async_callback.hpp"
+#include "ksr/dispatch_queue.hpp"
+#include "ksr/triple_buffer.hpp"
+#include "ksr/update_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace ksr;
+
+TEST_CASE("triple_buffer_latest", "[async_callback]") {
+
+    auto buffer = triple_buffer<int>{};
+    auto value = -1;
+
+    CHECK_FALSE(buffer.take(value));
+    CHECK(value == -1);
+
+    buffer.write(1);
+    buffer.write(2);
+    CHECK(buffer.pending());
+    CHECK(buffer.take(value));
+    CHECK(value == 2);
+    CHECK_FALSE(buffer.take(value));
+
+    buffer.write(3);
+    CHECK(buffer.take(value));
+    CHECK(value == 3);
+}
+
+TEST_CASE("dispatch_queue_order", "[async_callback]") {
+
+    struct item : public dispatch_queue::node {
+
+        item(std::vector<int>& log, const int id)
+          : dispatch_queue::node{&run}, log{log}, id{id} {}
+
+        static void run(dispatch_queue::node& self) {
+            auto& this_item = static_cast<item&>(self);
+            this_item.log.push_back(this_item.id);
+        }
+
+        std::vector<int>& log;
+        int id;
+    };
+
+    auto notifications = 0;
+    auto queue = dispatch_queue{[&] { ++notifications; }};
+    auto log = std::vector<int>{};
+    item items[] = {{log, 0}, {log, 1}, {log, 2}};
+
+    for (auto& each : items) {
+        queue.post(each);
+    }
+
+    CHECK(notifications == 3);
+    CHECK(queue.drain(2) == 2);
+    CHECK(queue.drain() == 1);
+    CHECK(queue.drain() == 0);
+    CHECK(log == (std::vector<int>{0, 1, 2}));
+
+    // Nodes may be posted again once they have been run.
+
+    queue.post(items[1]);
+    CHECK(queue.drain() == 1);
+    CHECK(log.back() == 1);
+}
+
+TEST_CASE("async_callback_coalesce", "[async_callback]") {
+
+    auto queue = dispatch_queue{};
+    auto delivered = std::vector<int>{};
+    auto filter = basic_update_filter{update_filter_tag<filter_policy::int_percentage, int, int>{},
+        async_callback<int, int>{queue, [&](const int count, int) { delivered.push_back(count); }}};
+
+    for (auto count = 0; count <= 100; ++count) {
+        filter.update(count, 100);
+    }
+
+    CHECK(delivered.empty());
+    CHECK(queue.drain() == 1);
+    CHECK(delivered == (std::vector<int>{100}));
+
+    filter.sync(0, 100);
+    filter.sync(50, 100);
+    CHECK(queue.drain() == 1);
+    CHECK(delivered == (std::vector<int>{100, 50}));
+}
+
+TEST_CASE("async_callback_executor", "[async_callback]") {
+
+    auto tasks = std::vector<async_callback<int>::task>{};
+    auto executor = [&tasks](async_callback<int>::task task) { tasks.push_back(std::move(task)); };
+    auto delivered = std::vector<int>{};
+
+    {
+        auto callback = async_callback<int>{executor, [&](const int value) { delivered.push_back(value); }};
+        callback(1);
+        callback(2);
+        CHECK(tasks.size() == 1);
+    }
+
+    // The task keeps the delivery state alive after the callback itself has been destroyed.
+
+    tasks.front()();
+    CHECK(delivered == (std::vector<int>{2}));
+}
+
+TEST_CASE("async_callback_threads", "[async_callback]") {
+
+    constexpr auto final_value = 100000;
+
+    auto queue = dispatch_queue{};
+    auto last = std::atomic<int>{-1};
+    auto deliveries = 0;
+    auto ordered = true;
+
+    auto callback = async_callback<int>{queue, [&](const int value) {
+        ordered = ordered && value > last.load();
+        last = value;
+        ++deliveries;
+    }};
+
+    auto producer = std::thread{[&] {
+        for (auto value = 0; value <= final_value; ++value) {
+            callback(value);
+        }
+    }};
+
+    while (last.load() != final_value) {
+        queue.drain();
+    }
+
+    producer.join();
+    queue.drain();
+
+    CHECK(ordered);
+    CHECK(last == final_value);
+    CHECK(deliveries <= final_value + 1);
+}
@@ -0,0 +1,61 @@
+#include "ksr/clock.hpp"
+
+#include "catch/catch.hpp"
+
+#include <array>
+#include <chrono>
+#include <thread>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    template <typename chrono_clock_t>
+    auto measures_sleep() -> bool {
+
+        const auto start = chrono_clock_t::now();
+        std::this_thread::sleep_for(20ms);
+        const auto elapsed = chrono_clock_t::now() - start;
+
+        // The coarse clock may lag by up to a scheduler tick at either end.
+        return elapsed >= 10ms && elapsed < 1s;
+    }
+}
+
+TEST_CASE("coarse_steady_clock", "[clock]") {
+    CHECK(measures_sleep<coarse_steady_clock>());
+}
+
+#ifdef KSR_HAS_TSC_CLOCK
+TEST_CASE("tsc_clock", "[clock]") {
+    tsc_clock::calibrate();
+    CHECK(measures_sleep<tsc_clock>());
+}
+#endif
+
+TEST_CASE("manual_clock", "[clock]") {
+
+    manual_clock::set(manual_clock::time_point{1s});
+    CHECK(manual_clock::now().time_since_epoch() == 1s);
+
+    manual_clock::advance(5ms);
+    CHECK(manual_clock::now().time_since_epoch() == 1005ms);
+}
+
+TEST_CASE("every_nth_clock", "[clock]") {
+
+    manual_clock::set({});
+    auto clock = every_nth_clock<manual_clock, 3>{};
+
+    using readings_t = std::array<manual_clock::duration, 6>;
+    constexpr auto expected = readings_t{0ms, 0ms, 0ms, 3ms, 3ms, 3ms};
+
+    auto readings = readings_t{};
+    for (auto& reading : readings) {
+        reading = clock.now().time_since_epoch();
+        manual_clock::advance(1ms);
+    }
+
+    CHECK(readings == expected);
+}
@@ -0,0 +1,184 @@
+#include "ksr/clock.hpp"
+#include "ksr/concurrent_update_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    // Calls update_fn(thread_index, call_index) many times from each of several threads at once.
+
+    template <typename update_fn_t>
+    void race_updates(const update_fn_t& update_fn) {
+
+        static constexpr auto thread_count = 4;
+        static constexpr auto call_count = 200;
+
+        auto threads = std::vector<std::thread>{};
+        for (auto i = 0; i < thread_count; ++i) {
+            threads.emplace_back([&, i] {
+                for (auto j = 0; j < call_count; ++j) {
+                    update_fn(i, j);
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+TEST_CASE("concurrent_percentage_sequential", "[concurrent_update_filter]") {
+
+    auto update_count = 0;
+    auto filter = concurrent_int_percentage_filter<int>{[&](int, int) {
+        ++update_count;
+    }};
+
+    static constexpr auto max = 1000;
+    for (auto i = 0; i < max; ++i) {
+        filter.update(i, max);
+    }
+
+    CHECK(update_count == 101);
+
+    const auto& [count, total] = filter;
+    CHECK(count == 995);
+    CHECK(total == max);
+
+    filter.sync(max, max);
+    CHECK(update_count == 102);
+    CHECK(get<0>(filter) == max);
+}
+
+TEST_CASE("concurrent_percentage_zero_total", "[concurrent_update_filter]") {
+
+    auto update_count = 0;
+    auto filter = concurrent_int_percentage_filter<int>{[&](int, int) {
+        ++update_count;
+    }};
+
+    // As for int_percentage_filter, updates are accepted while the last-actioned total is zero.
+
+    CHECK(filter.update(0, 0));
+    CHECK(filter.update(0, 0));
+    CHECK(filter.update(5, 10));
+    CHECK(!filter.update(5, 10));
+
+    filter.sync(0, 0);
+    CHECK(filter.update(1, 10));
+    CHECK(update_count == 5);
+
+#ifdef KSR_THROW_ON_ASSERT
+    CHECK_THROWS_AS(filter.update(1, 0), ksr::logic_error);
+#endif
+}
+
+TEST_CASE("concurrent_percentage_threads", "[concurrent_update_filter]") {
+
+    static constexpr auto max = 100000;
+    static constexpr auto thread_count = 4;
+
+    auto mutex = std::mutex{};
+    auto percentages = std::vector<int>{};
+
+    auto filter = concurrent_int_percentage_filter<long>{[&](const long count, const long total) {
+        const auto lock = std::lock_guard{mutex};
+        percentages.push_back(int_percentage(count, total));
+    }};
+
+    auto next = std::atomic<long>{0};
+    auto threads = std::vector<std::thread>{};
+    for (auto i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&] {
+            for (auto count = next++; count < max; count = next++) {
+                filter.update(count, long{max});
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Updates may reach the filter out of order, so some percentages can be skipped, but none can
+    // be actioned twice.
+
+    std::sort(percentages.begin(), percentages.end());
+    CHECK(std::adjacent_find(percentages.begin(), percentages.end()) == percentages.end());
+    CHECK(percentages.size() <= 101);
+    CHECK(percentages.front() == 0);
+    CHECK(percentages.back() == 100);
+}
+
+TEST_CASE("concurrent_percentage_claims", "[concurrent_update_filter]") {
+
+    auto update_count = std::atomic<int>{0};
+    auto filter = concurrent_int_percentage_filter<int>{[&](int, int) {
+        ++update_count;
+    }};
+
+    // Every thread sends the same data for each percentage, which exactly one of them claims.
+
+    for (auto percentage = 0; percentage <= 100; percentage += 5) {
+        race_updates([&](int, int) {
+            filter.update(percentage * 10, 1000);
+        });
+        CHECK(update_count == percentage / 5 + 1);
+    }
+}
+
+TEST_CASE("concurrent_sampled", "[concurrent_update_filter]") {
+
+    auto update_count = std::atomic<int>{0};
+    auto filter = concurrent_sampled_filter<int>{1s, [&](int) {
+        ++update_count;
+    }};
+
+    CHECK(filter.update(1));
+    CHECK(!filter.update(2));
+    CHECK(!filter.update(1));
+
+    filter.sync(3);
+    CHECK(update_count == 2);
+    CHECK(get<0>(filter) == 3);
+}
+
+TEST_CASE("concurrent_sampled_claims", "[concurrent_update_filter]") {
+
+    manual_clock::set(manual_clock::time_point{});
+
+    auto update_count = std::atomic<int>{0};
+    auto filter = basic_concurrent_sampled_filter<manual_clock, int>{100ms, [&](int) {
+        ++update_count;
+    }};
+
+    // Every thread sends distinct data within each interval, of which exactly one update is
+    // claimed. The clock only changes between races, as manual_clock isn't thread-safe.
+
+    for (auto interval = 0; interval < 10; ++interval) {
+        race_updates([&](const int thread_index, const int call_index) {
+            filter.update(1 + thread_index * 1000 + call_index);
+        });
+        CHECK(update_count == interval + 1);
+        manual_clock::advance(100ms);
+    }
+
+    race_updates([&](const int thread_index, const int call_index) {
+        filter.update(1 + thread_index * 1000 + call_index);
+    });
+    CHECK(update_count == 11);
+
+    manual_clock::advance(99ms);
+    CHECK(!filter.update(0));
+}
@@ -0,0 +1,180 @@
+#include "ksr/clock.hpp"
+#include "ksr/filter_bank.hpp"
+#include "ksr/update_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    // Checks that the dense comparison kernels agree with a plain loop for blocks of each size,
+    // over values at the extremes of t and values that differ only in the low half of a 64-bit
+    // word (which SSE2 compares separately).
+
+    template <typename t>
+    auto mask_matches_loop() -> bool {
+
+        using limits = std::numeric_limits<t>;
+        const auto edges = std::vector<t>{
+            limits::lowest(), static_cast<t>(limits::lowest() + 1), t{0}, t{1}, static_cast<t>(limits::max() - 1),
+            limits::max(), static_cast<t>(0x7fffffff), static_cast<t>(0x80000000), static_cast<t>(0xffffffff)};
+
+        // Each round pairs every edge value of the counts with a different run of thresholds, so
+        // that every pair is compared in some round.
+
+        auto counts = std::vector<t>(64);
+        auto thresholds = std::vector<t>(64);
+        for (auto round = std::size_t{0}; round < edges.size(); ++round) {
+
+            for (auto i = std::size_t{0}; i < 64; ++i) {
+                counts[i] = edges[i % edges.size()];
+                thresholds[i] = edges[(i / edges.size() + round) % edges.size()];
+            }
+
+            for (auto size = std::size_t{0}; size <= 64; ++size) {
+
+                const auto expected = detail::bank_mask_at_least_loop(counts.data(), thresholds.data(), size);
+                if (detail::bank_mask_at_least(counts.data(), thresholds.data(), size) != expected) {
+                    return false;
+                }
+
+#ifdef KSR_HAS_SIMD_FIND
+                if (detail::bank_mask_at_least_sse2(counts.data(), thresholds.data(), size) != expected) {
+                    return false;
+                }
+#endif
+            }
+        }
+
+        return true;
+    }
+}
+
+TEST_CASE("fraction_filter_bank_matches_filter", "[filter_bank]") {
+
+    // Each filter in the bank should fire on exactly the same updates as a standalone
+    // int_percentage_filter given the same sequence of counts.
+
+    constexpr auto filter_count = 150;
+
+    auto bank = int_percentage_filter_bank<>{};
+    auto filters = std::vector<int_percentage_filter<std::int64_t>>{};
+    auto expected_fired = std::vector<std::size_t>{};
+
+    for (auto i = 0; i < filter_count; ++i) {
+        const auto total = std::int64_t{37 + 13 * i};
+        CHECK(bank.add(total) == static_cast<std::size_t>(i));
+        filters.emplace_back([&expected_fired, i](std::int64_t, std::int64_t) {
+            expected_fired.push_back(static_cast<std::size_t>(i));
+        });
+    }
+
+    auto counts = std::vector<std::int64_t>(filter_count);
+    auto bitmap = filter_bank_bitmap{};
+
+    for (auto step = 0; step < 60; ++step) {
+
+        for (auto i = 0; i < filter_count; ++i) {
+            counts[static_cast<std::size_t>(i)] += (i + step) % 7;
+        }
+
+        expected_fired.clear();
+        for (auto i = 0; i < filter_count; ++i) {
+            filters[static_cast<std::size_t>(i)].update(counts[static_cast<std::size_t>(i)], 37 + 13 * i);
+        }
+
+        const auto fired_count = bank.update(0, counts.data(), counts.data() + counts.size(), bitmap);
+        CHECK(fired_count == expected_fired.size());
+        REQUIRE(bitmap.size() == 3);
+
+        auto fired = std::vector<std::size_t>{};
+        for (auto i = std::size_t{0}; i < filter_count; ++i) {
+            if (bitmap[i / 64] >> (i % 64) & 1) {
+                fired.push_back(i);
+            }
+        }
+
+        CHECK(fired == expected_fired);
+    }
+
+    for (auto i = std::size_t{0}; i < filter_count; ++i) {
+        CHECK(bank.count(i) == ksr::get<0>(filters[i]));
+        CHECK(bank.fraction(i) == ksr::int_percentage(filters[i]));
+    }
+}
+
+TEST_CASE("fraction_filter_bank_mask", "[filter_bank]") {
+    CHECK(mask_matches_loop<std::int32_t>());
+    CHECK(mask_matches_loop<std::uint32_t>());
+    CHECK(mask_matches_loop<std::int64_t>());
+    CHECK(mask_matches_loop<std::uint64_t>());
+}
+
+TEST_CASE("fraction_filter_bank_sparse", "[filter_bank]") {
+
+    auto bank = int_percentage_filter_bank<int>{};
+    bank.add(100);
+    bank.add(1000);
+    bank.add(0);
+
+    const auto ids = std::vector<std::size_t>{1, 0, 2};
+    auto fired = std::vector<std::size_t>{};
+
+    bank.update(ids.begin(), ids.end(), std::vector<int>{1, 1, 1}.begin(), std::back_inserter(fired));
+    CHECK(fired == (std::vector<std::size_t>{1, 0}));
+
+    fired.clear();
+    bank.update(ids.begin(), ids.end(), std::vector<int>{5, 1, 5}.begin(), std::back_inserter(fired));
+    CHECK(fired == (std::vector<std::size_t>{1}));
+    CHECK(bank.fraction(1) == 1);
+
+    // Changing the total makes the next update fire unconditionally.
+
+    bank.set_total(0, 50);
+    fired.clear();
+    bank.update(ids.begin() + 1, ids.end(), std::vector<int>{1, 1}.begin(), std::back_inserter(fired));
+    CHECK(fired == (std::vector<std::size_t>{0}));
+    CHECK(bank.fraction(0) == 2);
+}
+
+TEST_CASE("sampled_filter_bank", "[filter_bank]") {
+
+    manual_clock::set(manual_clock::time_point{});
+
+    auto bank = basic_sampled_filter_bank<manual_clock, double>{20ms};
+    for (auto i = 0; i < 70; ++i) {
+        bank.add();
+    }
+
+    auto values = std::vector<double>(70, 1.0);
+    auto bitmap = filter_bank_bitmap{};
+
+    CHECK(bank.update(0, values.data(), values.data() + values.size(), bitmap) == 70);
+    CHECK(bitmap == (filter_bank_bitmap{UINT64_MAX, 0x3f}));
+
+    values[3] = 2.0;
+    manual_clock::advance(10ms);
+    CHECK(bank.update(0, values.data(), values.data() + values.size(), bitmap) == 0);
+
+    // Only changed values fire once the interval has elapsed.
+
+    manual_clock::advance(10ms);
+    CHECK(bank.update(0, values.data(), values.data() + values.size(), bitmap) == 1);
+    CHECK(bitmap == (filter_bank_bitmap{0x8, 0}));
+    CHECK(bank.value(3) == 2.0);
+
+    const auto ids = std::vector<std::size_t>{65, 3};
+    auto fired = std::vector<std::size_t>{};
+    manual_clock::advance(20ms);
+    bank.update(ids.begin(), ids.end(), std::vector<double>{3.0, 3.0}.begin(), std::back_inserter(fired));
+    CHECK(fired == (std::vector<std::size_t>{65, 3}));
+}
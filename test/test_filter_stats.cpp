@@ -0,0 +1,83 @@
+#include "ksr/filter_stats.hpp"
+#include "ksr/update_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ksr;
+
+namespace {
+
+    auto find_stats(const std::string& name) -> filter_stats_snapshot {
+        const auto all = filter_stats();
+        const auto iter = std::find_if(all.begin(), all.end(), [&](const filter_stats_snapshot& snapshot) {
+            return snapshot.name == name;
+        });
+        return iter != all.end() ? *iter : filter_stats_snapshot{};
+    }
+}
+
+TEST_CASE("filter_stats_counts", "[filter_stats]") {
+
+    if (!filter_stats_enabled()) {
+        CHECK(filter_stats().empty());
+        return;
+    }
+
+    {
+        auto filter = int_percentage_filter<int>{[](int, int) {}};
+        filter.set_stats_name("counts");
+
+        for (auto i = 0; i <= 1000; ++i) {
+            filter.update(i, 1000);
+        }
+        filter.sync(1000, 1000);
+
+        const auto stats = find_stats("counts");
+        CHECK(stats.calls == 1001);
+        CHECK(stats.accepted == 101);
+        CHECK(stats.rejected == 900);
+        CHECK(stats.syncs == 1);
+
+        auto timed = std::uint64_t{0};
+        for (const auto count : stats.callback_latency) {
+            timed += count;
+        }
+        CHECK(timed == 102);
+
+        // A copy is registered separately, with fresh counters.
+
+        const auto copy = filter;
+        const auto all = filter_stats();
+        CHECK(std::count_if(all.begin(), all.end(),
+            [](const filter_stats_snapshot& snapshot) { return snapshot.name == "counts"; }) == 2);
+    }
+
+    CHECK(find_stats("counts").calls == 0);
+}
+
+TEST_CASE("filter_stats_json", "[filter_stats]") {
+
+    if (!filter_stats_enabled()) {
+        auto out = std::ostringstream{};
+        dump_filter_stats_json(out);
+        CHECK(out.str() == "[]");
+        return;
+    }
+
+    auto filter = update_filter<filter_policy::int_percentage, int, int>{[](int, int) {}};
+    filter.set_stats_name("say \"hi\"\n");
+    filter.update(1, 2);
+
+    auto out = std::ostringstream{};
+    dump_filter_stats_json(out);
+    const auto json = out.str();
+
+    CHECK(json.front() == '[');
+    CHECK(json.back() == ']');
+    CHECK(json.find(R"("name": "say \"hi\"\u000a", "calls": 1, "accepted": 1, "rejected": 0, "syncs": 0)") != std::string::npos);
+}
@@ -0,0 +1,46 @@
+#include "ksr/inplace_function.hpp"
+
+#include "catch/catch.hpp"
+
+#include <memory>
+#include <utility>
+
+using namespace ksr;
+
+TEST_CASE("inplace_function_invoke", "[inplace_function]") {
+
+    auto offset = 10;
+    auto fn = inplace_function<int(int)>{[&offset](const int value) { return value + offset; }};
+
+    REQUIRE(fn);
+    CHECK(fn(1) == 11);
+
+    offset = 20;
+    CHECK(fn(1) == 21);
+
+    CHECK(!inplace_function<void()>{});
+}
+
+TEST_CASE("inplace_function_lifetime", "[inplace_function]") {
+
+    const auto counter = std::make_shared<int>(0);
+    {
+        auto fn = inplace_function<int()>{[counter] { return ++*counter; }};
+        CHECK(counter.use_count() == 2);
+
+        auto copy = fn;
+        CHECK(counter.use_count() == 3);
+        CHECK(copy() == 1);
+        CHECK(fn() == 2);
+
+        auto moved = std::move(fn);
+        CHECK(!fn);
+        CHECK(counter.use_count() == 3);
+
+        copy = moved;
+        CHECK(counter.use_count() == 3);
+        CHECK(copy() == 3);
+    }
+
+    CHECK(counter.use_count() == 1);
+}
@@ -0,0 +1,240 @@
+#include "ksr/clock.hpp"
+#include "ksr/policy_combinators.hpp"
+#include "ksr/update_filter.hpp"
+
+#include "catch/catch.hpp"
+#include "counting_clock.hpp"
+
+#include <chrono>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    // The clock is read once per evaluation of sampled, so its reads show whether cheaper
+    // policies are evaluated first.
+
+    using ksr_test::counting_clock;
+
+    template <typename... value_ts>
+    using counted_sampled = filter_policy::basic_sampled<counting_clock>::policy<value_ts...>;
+
+    template <typename... value_ts>
+    using manual_sampled = filter_policy::basic_sampled<manual_clock>::policy<value_ts...>;
+
+    using percent_and_20ms = filter_policy::all_of<counted_sampled, filter_policy::int_percentage>;
+    using percent_or_20ms = filter_policy::any_of<filter_policy::int_percentage, manual_sampled>;
+
+    // Accepts even values only, and costs more to evaluate than sampled, so that all_of asks it
+    // second.
+
+    template <typename... value_ts>
+    class even_only {
+    public:
+
+        static constexpr auto evaluation_cost = 20;
+
+    protected:
+
+        auto can_update(const std::tuple<int>&, const std::tuple<const int&>& new_values) const -> bool {
+            return std::get<0>(new_values) % 2 == 0;
+        }
+    };
+
+    // Counts the updates that it is asked about and those actioned, through accessors named as
+    // int_percentage's are, which (as they don't read the filter's data) remain available
+    // within combinators.
+
+    template <typename... value_ts>
+    class tally {
+    public:
+
+        auto count() const -> int {
+            return m_asked;
+        }
+
+        auto total() const -> int {
+            return m_actioned;
+        }
+
+    protected:
+
+        auto can_update(const std::tuple<value_ts...>&, const std::tuple<const value_ts&...>&) const -> bool {
+            ++m_asked;
+            return true;
+        }
+
+        void on_update(const std::tuple<value_ts...>&) {
+            ++m_actioned;
+        }
+
+    private:
+
+        mutable int m_asked = 0;
+        int m_actioned = 0;
+    };
+
+    template <typename filter_t>
+    constexpr auto has_count(int) -> decltype(std::declval<const filter_t&>().count(), bool{}) { return true; }
+
+    template <typename filter_t>
+    constexpr auto has_count(...) -> bool { return false; }
+}
+
+TEST_CASE("policy_all_of", "[policy_combinators]") {
+
+    manual_clock::set({});
+    counting_clock::reads = 0;
+
+    auto percentages = std::vector<int>{};
+    auto filter = update_filter<percent_and_20ms::policy, int, int>{20ms, [&](const int count, int) {
+        percentages.push_back(count);
+    }};
+
+    static_assert(!std::is_default_constructible_v<percent_and_20ms::policy<int, int>>);
+    static_assert(percent_and_20ms::policy<int, int>::evaluation_cost == 11);
+
+    CHECK(filter.update(0, 100));
+    CHECK(counting_clock::reads == 1);
+
+    // The percentage hasn't changed, so the clock isn't read.
+
+    manual_clock::advance(30ms);
+    CHECK_FALSE(filter.update(0, 100));
+    CHECK(counting_clock::reads == 1);
+
+    // The percentage has changed, but 20ms haven't elapsed since the last actioned update.
+
+    CHECK(filter.update(5, 100));
+    manual_clock::advance(10ms);
+    CHECK_FALSE(filter.update(10, 100));
+    CHECK(counting_clock::reads == 3);
+
+    // The rejection above didn't restart the interval.
+
+    manual_clock::advance(10ms);
+    CHECK(filter.update(10, 100));
+    CHECK(percentages == (std::vector<int>{0, 5, 10}));
+
+    // sync() restarts the interval.
+
+    filter.sync(20, 100);
+    manual_clock::advance(10ms);
+    CHECK_FALSE(filter.update(30, 100));
+}
+
+TEST_CASE("policy_state_accessors", "[policy_combinators]") {
+
+    // int_percentage's count() and total() can't reach the data of a combined filter, so are
+    // hidden; ksr::get() reads them instead.
+
+    using percent_and_sampled = filter_policy::all_of<filter_policy::int_percentage, filter_policy::sampled>;
+    using filter_t = update_filter<percent_and_sampled::policy, int, int>;
+
+    static_assert(has_count<update_filter<filter_policy::int_percentage, int, int>>(int{}));
+    static_assert(!has_count<filter_t>(int{}));
+    static_assert(!has_count<update_filter<filter_policy::not_<filter_policy::int_percentage>::policy, int, int>>(int{}));
+
+    auto filter = filter_t{20ms, [](int, int) {}};
+    CHECK(filter.update(37, 100));
+    CHECK(get<0>(filter) == 37);
+    CHECK(get<1>(filter) == 100);
+
+    // Accessors of other policies aren't hidden.
+
+    manual_clock::set({});
+
+    auto tallied = update_filter<filter_policy::all_of<tally, manual_sampled>::policy, int, int>{20ms, [](int, int) {}};
+    CHECK(tallied.update(1, 2));
+    CHECK_FALSE(tallied.update(2, 2));
+    CHECK(tallied.count() == 2);
+    CHECK(tallied.total() == 1);
+}
+
+TEST_CASE("policy_any_of", "[policy_combinators]") {
+
+    manual_clock::set({});
+
+    auto filter = update_filter<percent_or_20ms::policy, int, int>{20ms, [](int, int) {}};
+
+    CHECK(filter.update(0, 1000));
+    CHECK_FALSE(filter.update(1, 1000));
+    CHECK(filter.update(10, 1000));
+
+    // The percentage update restarted the interval.
+
+    manual_clock::advance(15ms);
+    CHECK_FALSE(filter.update(11, 1000));
+    manual_clock::advance(5ms);
+    CHECK(filter.update(11, 1000));
+    CHECK_FALSE(filter.update(11, 1000));
+}
+
+TEST_CASE("policy_not", "[policy_combinators]") {
+
+    using not_percentage = filter_policy::not_<filter_policy::int_percentage>;
+    using either = filter_policy::any_of<filter_policy::int_percentage, not_percentage::policy>;
+
+    static_assert(std::is_default_constructible_v<either::policy<int, int>>);
+
+    auto inverted = update_filter<not_percentage::policy, int, int>{[](int, int) {}};
+    CHECK_FALSE(inverted.update(1, 100));
+    inverted.sync(1, 100);
+    CHECK(inverted.update(1, 100));
+    CHECK_FALSE(inverted.update(50, 100));
+
+    auto always = update_filter<either::policy, int, int>{[](int, int) {}};
+    CHECK(always.update(1, 100));
+    CHECK(always.update(1, 100));
+}
+
+TEST_CASE("policy_rejected_sample", "[policy_combinators]") {
+
+    // When sampled accepts an update that the combination rejects, a later sync() restarts the
+    // interval from the time of the sync(), not from that of the rejected update.
+
+    manual_clock::set({});
+
+    using sampled_and_even = filter_policy::all_of<manual_sampled, even_only>;
+    auto both = update_filter<sampled_and_even::policy, int>{20ms, [](int) {}};
+
+    CHECK_FALSE(both.update(1));
+    manual_clock::advance(15ms);
+    both.sync(2);
+    manual_clock::advance(10ms);
+    CHECK_FALSE(both.update(4));
+    manual_clock::advance(10ms);
+    CHECK(both.update(4));
+
+    manual_clock::set({});
+
+    using not_sampled = filter_policy::not_<manual_sampled>;
+    auto inverted = update_filter<not_sampled::policy, int>{20ms, [](int) {}};
+
+    CHECK_FALSE(inverted.update(1));
+    manual_clock::advance(15ms);
+    inverted.sync(2);
+    manual_clock::advance(10ms);
+    CHECK(inverted.update(3));
+}
+
+TEST_CASE("policy_data_tuple", "[policy_combinators]") {
+
+    manual_clock::set({});
+
+    // Both constituents need an interval, so the data are passed as a tuple, in order.
+
+    using both_sampled = filter_policy::all_of<manual_sampled, manual_sampled>;
+    auto filter = update_filter<both_sampled::policy, int>{std::tuple{10ms, 30ms}, [](int) {}};
+
+    CHECK(filter.update(1));
+    manual_clock::advance(20ms);
+    CHECK_FALSE(filter.update(2));
+    manual_clock::advance(10ms);
+    CHECK(filter.update(2));
+}
@@ -0,0 +1,89 @@
+#include "ksr/math.hpp"
+#include "ksr/polled_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+TEST_CASE("polled_filter_poll", "[polled_filter]") {
+
+    auto percentages = std::vector<int>{};
+    auto filter = polled_filter<filter_policy::int_percentage, int, int>{
+        [&](const int count, const int total) { percentages.push_back(int_percentage(count, total)); }};
+
+    filter.store<1>(400);
+    CHECK(filter.poll());
+    CHECK_FALSE(filter.poll());
+
+    filter.add<0>(1);
+    CHECK_FALSE(filter.poll());
+
+    filter.add<0>(1);
+    CHECK(filter.poll());
+
+    for (auto i = 0; i < 200; ++i) {
+        filter.add<0>(1);
+    }
+
+    CHECK(filter.poll());
+    CHECK(percentages == (std::vector<int>{0, 1, 51}));
+
+    const auto& [count, total] = filter;
+    CHECK(count == 202);
+    CHECK(total == 400);
+
+    filter.sync();
+    CHECK(percentages.size() == 4);
+}
+
+TEST_CASE("polled_filter_sampler", "[polled_filter]") {
+
+    constexpr auto thread_count = 4;
+    constexpr auto items_per_thread = 100000;
+
+    auto last_count = std::atomic<int>{0};
+    auto filter = polled_filter<filter_policy::int_percentage, int, int>{
+        [&](const int count, int) { last_count = count; }};
+    filter.store<1>(thread_count * items_per_thread);
+
+    auto sampler = poll_sampler{1ms};
+    const auto id = sampler.attach(filter);
+
+    auto threads = std::vector<std::thread>{};
+    for (auto i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&] {
+            for (auto item = 0; item < items_per_thread; ++item) {
+                filter.add<0>(1);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The sampler notices 100% within a tick or two, though not necessarily the final count,
+    // which may only have been reached after the percentage last changed; sync() delivers that.
+
+    const auto total = thread_count * items_per_thread;
+    const auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (int_percentage(last_count.load(), total) != 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    CHECK(int_percentage(last_count.load(), total) == 100);
+
+    sampler.detach(id);
+    filter.sync();
+    CHECK(last_count == thread_count * items_per_thread);
+
+    filter.store<0>(0);
+    std::this_thread::sleep_for(5ms);
+    CHECK(last_count == thread_count * items_per_thread);
+}
@@ -0,0 +1,113 @@
+#include "ksr/progress_stream.hpp"
+
+#ifdef KSR_HAS_PROGRESS_STREAM
+
+#include "ksr/dispatch_queue.hpp"
+#include "ksr/update_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace ksr;
+
+namespace {
+
+    // A coroutine that starts immediately and is never awaited, which is all a consumer of a
+    // progress_stream needs in these tests.
+
+    struct detached {
+        struct promise_type {
+            auto get_return_object() noexcept -> detached { return {}; }
+            auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+            auto final_suspend() noexcept -> std::suspend_never { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    auto consume(progress_stream<int, int>& stream, std::vector<int>& counts, std::atomic<bool>& done)
+        -> detached {
+
+        while (const auto update = co_await stream.next()) {
+            counts.push_back(std::get<0>(*update));
+        }
+
+        done = true;
+    }
+}
+
+TEST_CASE("progress_stream_coalesce", "[progress_stream]") {
+
+    auto queue = dispatch_queue{};
+    auto stream = progress_stream<int, int>{queue};
+    auto filter = basic_update_filter{
+        update_filter_tag<filter_policy::int_percentage, int, int>{}, stream.sink()};
+
+    auto counts = std::vector<int>{};
+    auto done = std::atomic<bool>{false};
+    consume(stream, counts, done);
+    CHECK(counts.empty());
+
+    // The consumer only runs when the queue is drained, by which time it sees only the latest of
+    // the updates that the filter accepted.
+
+    for (auto i = 0; i < 500; ++i) {
+        filter.update(i, 1000);
+    }
+
+    CHECK(counts.empty());
+    CHECK(queue.drain() == 1);
+    CHECK(counts == std::vector<int>{495});
+    CHECK(queue.drain() == 0);
+
+    filter.update(600, 1000);
+    stream.close();
+    CHECK_FALSE(done);
+    queue.drain();
+    CHECK((counts == std::vector<int>{495, 600}));
+    CHECK(done);
+}
+
+TEST_CASE("progress_stream_threads", "[progress_stream]") {
+
+    static constexpr auto total = 1000000;
+
+    auto queue = dispatch_queue{};
+    auto stream = progress_stream<int, int>{queue};
+    auto filter = basic_update_filter{
+        update_filter_tag<filter_policy::int_percentage, int, int>{}, stream.sink()};
+
+    auto counts = std::vector<int>{};
+    auto done = std::atomic<bool>{false};
+    consume(stream, counts, done);
+
+    auto producer = std::thread{[&] {
+        for (auto i = 0; i < total; ++i) {
+            filter.update(i, total);
+        }
+        filter.sync(total, total);
+        stream.close();
+    }};
+
+    // This thread stands in for the consumer's event loop.
+
+    while (!done) {
+        queue.drain();
+        std::this_thread::yield();
+    }
+
+    producer.join();
+
+    REQUIRE_FALSE(counts.empty());
+    CHECK(counts.back() == total);
+    CHECK(std::is_sorted(counts.begin(), counts.end()));
+}
+
+#endif
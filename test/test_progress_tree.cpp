@@ -0,0 +1,136 @@
+#include "ksr/math.hpp"
+#include "ksr/progress_tree.hpp"
+
+#include "catch/catch.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace ksr;
+
+TEST_CASE("progress_tree_weights", "[progress_tree]") {
+
+    auto percentages = std::vector<int>{};
+    auto tree = progress_tree{[&](const std::int64_t done, const std::int64_t total) {
+        percentages.push_back(int_percentage(done, total));
+    }};
+
+    // The scan (weight 3) has a directory of two files, and the index (weight 1) is a single leaf.
+
+    const auto scan = tree.add_group(progress_tree::root, 3);
+    const auto file_a = tree.add_leaf(scan, 1, 10);
+    const auto file_b = tree.add_leaf(scan, 1, 0);
+    const auto index = tree.add_leaf(progress_tree::root, 1, 4);
+
+    CHECK(tree.refresh());
+    CHECK(percentages.back() == 0);
+    CHECK_FALSE(tree.refresh());
+
+    file_a.advance(5);
+    CHECK(tree.progress(file_a.id()) == progress_tree::resolution / 2);
+    CHECK(tree.progress(scan) == progress_tree::resolution / 4);
+    // The root is the weighted mean of the scan (weight 3, at a quarter) and the index (weight
+    // 1, at nothing): (3 * 250000 + 1 * 0) / 4 = 187500, i.e. 18.75%, which int_percentage()
+    // (like the root's int_percentage_filter) rounds to the nearest percent, 19, rather than
+    // truncating it to 18.
+
+    CHECK(tree.progress(progress_tree::root) == 187500);
+    CHECK(tree.refresh());
+    CHECK(percentages.back() == 19);
+    CHECK_FALSE(tree.refresh());
+
+    file_a.advance(5);
+    file_b.set_total(2);
+    file_b.advance(2);
+    CHECK(tree.refresh());
+    CHECK(percentages.back() == 75);
+
+    // With the scan complete and the index at three quarters, the root is at
+    // (3 * 1000000 + 1 * 750000) / 4 = 937500, i.e. 93.75%, which likewise rounds to 94.
+
+    index.advance(3);
+    CHECK(tree.progress(progress_tree::root) == 937500);
+    CHECK(tree.refresh());
+    CHECK(percentages.back() == 94);
+
+    // Excess progress is clamped to the leaf's total.
+
+    index.advance(3);
+    CHECK(tree.refresh());
+    CHECK(percentages.back() == 100);
+    CHECK(tree.progress(progress_tree::root) == progress_tree::resolution);
+
+    tree.sync();
+    CHECK(percentages.size() == 6);
+}
+
+TEST_CASE("progress_tree_large_values", "[progress_tree]") {
+
+    // Weights and totals whose products with the resolution (or with progress) far exceed 64
+    // bits are still combined exactly, rounding down.
+
+    auto tree = progress_tree{[](std::int64_t, std::int64_t) {}};
+
+    constexpr auto big = std::int64_t{4'000'000'000'000'000'000};
+    const auto done = tree.add_leaf(progress_tree::root, big, big);
+    const auto third = tree.add_leaf(progress_tree::root, big, 3 * (big / 2));
+
+    done.advance(big);
+    third.advance(big / 2);
+    CHECK(tree.progress(done.id()) == progress_tree::resolution);
+    CHECK(tree.progress(third.id()) == 333333);
+    CHECK(tree.progress(progress_tree::root) == (progress_tree::resolution + 333333) / 2);
+
+    third.advance(big / 2 * 2 - 1);
+    CHECK(tree.progress(third.id()) == progress_tree::resolution - 1);
+    CHECK(tree.progress(progress_tree::root) == progress_tree::resolution - 1);
+
+    third.advance(1);
+    CHECK(tree.progress(progress_tree::root) == progress_tree::resolution);
+
+    // The weights of a group's children must sum to at most INT64_MAX.
+
+    CHECK_THROWS_AS(tree.add_group(progress_tree::root, std::numeric_limits<std::int64_t>::max() - 2 * big + 1),
+        ksr::logic_error);
+    CHECK_NOTHROW(tree.add_group(progress_tree::root, std::numeric_limits<std::int64_t>::max() - 2 * big));
+}
+
+TEST_CASE("progress_tree_threads", "[progress_tree]") {
+
+    constexpr auto thread_count = 4;
+    constexpr auto items_per_thread = 100000;
+
+    auto last_percentage = -1;
+    auto tree = progress_tree{[&](const std::int64_t done, const std::int64_t total) {
+        last_percentage = int_percentage(done, total);
+    }};
+
+    const auto shared_leaf = tree.add_leaf(progress_tree::root, 1, thread_count * items_per_thread, thread_count);
+    const auto group = tree.add_group(progress_tree::root, 1);
+
+    auto threads = std::vector<std::thread>{};
+    for (auto i = 0; i < thread_count; ++i) {
+        const auto own_leaf = tree.add_leaf(group, 1, items_per_thread);
+        threads.emplace_back([=] {
+            for (auto item = 0; item < items_per_thread; ++item) {
+                shared_leaf.advance();
+                own_leaf.advance();
+            }
+        });
+    }
+
+    // Refresh concurrently with the workers, as a UI timer would.
+
+    while (tree.progress(progress_tree::root) < progress_tree::resolution) {
+        tree.refresh();
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    tree.refresh();
+    CHECK(last_percentage == 100);
+}
@@ -0,0 +1,147 @@
+#include "ksr/shared_progress.hpp"
+
+#ifdef KSR_HAS_SHARED_PROGRESS
+
+#include "ksr/update_filter.hpp"
+
+#include "catch/catch.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ksr;
+
+namespace {
+
+    auto temp_path(const char* const name) -> std::string {
+        return "/tmp/ksr_test_" + std::string{name} + "_" + std::to_string(::getpid());
+    }
+}
+
+TEST_CASE("shared_progress_round_trip", "[shared_progress]") {
+
+    const auto path = temp_path("round_trip");
+
+    {
+        auto filter = basic_update_filter{
+            update_filter_tag<filter_policy::int_percentage, std::int64_t, std::int64_t>{},
+            shared_progress_writer<std::int64_t, std::int64_t>{path}};
+
+        const auto reader = shared_progress_reader<std::int64_t, std::int64_t>{path};
+        CHECK_FALSE(reader.read());
+        CHECK(reader.publications() == 0);
+
+        filter.update(5, 10);
+        filter.update(5, 10);
+        filter.update(7, 10);
+        CHECK(reader.publications() == 2);
+
+        const auto values = reader.read();
+        REQUIRE(values);
+        CHECK((*values == std::tuple{std::int64_t{7}, std::int64_t{10}}));
+
+        // Readers of other data types are refused.
+
+        CHECK_THROWS_AS((shared_progress_reader<double, double>{path}), std::runtime_error);
+        CHECK_THROWS_AS((shared_progress_reader<int, std::int64_t, char>{path}), std::runtime_error);
+    }
+
+    // The data outlive the writer.
+
+    const auto reader = shared_progress_reader<std::int64_t, std::int64_t>{path};
+    CHECK(std::get<0>(*reader.read()) == 7);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("shared_progress_two_processes", "[shared_progress]") {
+
+    static constexpr auto total = std::int64_t{2000000};
+
+    const auto path = temp_path("two_processes");
+
+    // The data are spread over several words, each derived from the count, so that a torn read
+    // would be detected.
+
+    auto writer = shared_progress_writer<std::int64_t, std::int64_t, double, std::int32_t>{path};
+    const auto reader = shared_progress_reader<std::int64_t, std::int64_t, double, std::int32_t>{path};
+
+    const auto child = ::fork();
+    REQUIRE(child >= 0);
+
+    if (child == 0) {
+        for (auto i = std::int64_t{1}; i <= total; ++i) {
+            writer(i, -i, static_cast<double>(i) / 2, static_cast<std::int32_t>(i % 1000));
+        }
+        ::_exit(0);
+    }
+
+    auto reads = 0;
+    auto consistent = true;
+    auto last_count = std::int64_t{0};
+    auto monotonic = true;
+
+    // Reads until the last count is seen, polling now and then for the child having exited
+    // (after which one more read must see the last count) or the deadline having passed.
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{60};
+    auto status = 0;
+    auto exited = false;
+
+    for (auto polls = 0u; last_count < total; ++polls) {
+
+        const auto exited_before_read = exited;
+        if (const auto values = reader.read()) {
+            const auto [count, negated, half, remainder] = *values;
+            consistent = consistent && negated == -count && half == static_cast<double>(count) / 2 &&
+                remainder == count % 1000;
+            monotonic = monotonic && count >= last_count;
+            last_count = count;
+            ++reads;
+        }
+
+        if (exited_before_read) {
+            break;
+        }
+
+        if (polls % 1024 == 0) {
+            exited = ::waitpid(child, &status, WNOHANG) == child;
+            if (!exited && std::chrono::steady_clock::now() > deadline) {
+                break;
+            }
+        }
+    }
+
+    // The child should exit soon after its last publication; if it doesn't by the deadline, it
+    // is killed (and so fails the checks of its exit status).
+
+    while (!exited && last_count == total && std::chrono::steady_clock::now() <= deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        exited = ::waitpid(child, &status, WNOHANG) == child;
+    }
+
+    if (!exited) {
+        ::kill(child, SIGKILL);
+        ::waitpid(child, &status, 0);
+    }
+
+    CHECK(last_count == total);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    CHECK(reads > 0);
+    CHECK(consistent);
+    CHECK(monotonic);
+    CHECK(reader.publications() == static_cast<std::uint64_t>(total));
+
+    std::remove(path.c_str());
+}
+
+#endif
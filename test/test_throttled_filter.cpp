@@ -0,0 +1,147 @@
+#include "ksr/throttled_filter.hpp"
+#include "ksr/timer_wheel.hpp"
+
+#include "catch/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace ksr;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+    // Waits (for up to a second, to allow for a heavily loaded machine) for the condition to hold.
+
+    template <typename pred_t>
+    auto eventually(pred_t pred) -> bool {
+
+        const auto deadline = std::chrono::steady_clock::now() + 1s;
+        while (!pred()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+
+    struct recorder {
+
+        void operator()(const int value) {
+            const auto lock = std::lock_guard{mutex};
+            values.push_back(value);
+        }
+
+        auto get() const -> std::vector<int> {
+            const auto lock = std::lock_guard{mutex};
+            return values;
+        }
+
+        mutable std::mutex mutex;
+        std::vector<int> values;
+    };
+
+    using callback = std::reference_wrapper<recorder>;
+}
+
+TEST_CASE("timer_wheel_schedule", "[timer_wheel]") {
+
+    auto wheel = timer_wheel{1ms, 8};
+    auto order = recorder{};
+
+    wheel.schedule(30ms, [&] { order(3); });
+    wheel.schedule(10ms, [&] { order(1); });
+    wheel.schedule(20ms, [&] { order(2); });
+    const auto cancelled = wheel.schedule(15ms, [&] { order(-1); });
+
+    CHECK(wheel.cancel(cancelled));
+    CHECK(eventually([&] { return order.get().size() == 3; }));
+    CHECK((order.get() == std::vector<int>{1, 2, 3}));
+}
+
+TEST_CASE("throttle_both", "[throttled_filter]") {
+
+    auto wheel = timer_wheel{1ms};
+    auto delivered = recorder{};
+    auto filter = basic_throttled_filter<throttle_edge::both, callback, int>{20ms, std::ref(delivered), wheel};
+
+    CHECK(filter.update(1));
+    CHECK(!filter.update(2));
+    CHECK(!filter.update(3));
+    CHECK((delivered.get() == std::vector<int>{1}));
+
+    CHECK(eventually([&] { return delivered.get().size() == 2; }));
+    CHECK((delivered.get() == std::vector<int>{1, 3}));
+    CHECK(get<0>(filter) == 3);
+}
+
+TEST_CASE("throttle_leading", "[throttled_filter]") {
+
+    auto wheel = timer_wheel{1ms};
+    auto delivered = recorder{};
+    auto filter = basic_throttled_filter<throttle_edge::leading, callback, int>{20ms, std::ref(delivered), wheel};
+
+    CHECK(filter.update(1));
+    CHECK(!filter.update(2));
+
+    std::this_thread::sleep_for(40ms);
+    CHECK((delivered.get() == std::vector<int>{1}));
+
+    CHECK(filter.update(3));
+    CHECK((delivered.get() == std::vector<int>{1, 3}));
+}
+
+TEST_CASE("throttle_trailing", "[throttled_filter]") {
+
+    auto wheel = timer_wheel{1ms};
+    auto delivered = recorder{};
+    auto filter = basic_throttled_filter<throttle_edge::trailing, callback, int>{20ms, std::ref(delivered), wheel};
+
+    CHECK(!filter.update(1));
+    CHECK(!filter.update(2));
+    CHECK(delivered.get().empty());
+
+    CHECK(eventually([&] { return !delivered.get().empty(); }));
+    CHECK((delivered.get() == std::vector<int>{2}));
+
+    filter.sync(4);
+    CHECK((delivered.get() == std::vector<int>{2, 4}));
+}
+
+TEST_CASE("throttle_destroy_same_tick", "[throttled_filter]") {
+
+    // The windows of both filters close on the same tick of this coarse wheel, so the second
+    // filter's timer has expired, but not started, while the first filter delivers; destroying
+    // the second filter then must still cancel it.
+
+    auto wheel = timer_wheel{50ms};
+    auto entered = std::atomic<bool>{false};
+    auto released = std::atomic<bool>{false};
+    auto late = std::atomic<int>{0};
+
+    auto first = throttled_filter<throttle_edge::trailing, int>{50ms, [&](int) {
+        entered = true;
+        while (!released) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }, wheel};
+
+    auto second = std::make_unique<throttled_filter<throttle_edge::trailing, int>>(
+        50ms, [&](int) { ++late; }, wheel);
+
+    first.update(1);
+    second->update(1);
+
+    REQUIRE(eventually([&] { return entered.load(); }));
+    second.reset();
+    released = true;
+
+    std::this_thread::sleep_for(100ms);
+    CHECK(late == 0);
+}
@@ -1,13 +1,56 @@
+#include "ksr/clock.hpp"
 #include "ksr/update_filter.hpp"
 
 #include "catch/catch.hpp"
+#include "counting_clock.hpp"
 
 #include <chrono>
+#include <cstdint>
+#include <optional>
 #include <thread>
+#include <tuple>
+#include <type_traits>
 
 using namespace ksr;
 using namespace std::literals::chrono_literals;
 
+namespace {
+
+    // Counts the copies and moves made of its instances, to check that update_filter only copies
+    // data that it actually stores.
+
+    struct tracked {
+
+        tracked() = default;
+        explicit tracked(const int value) : value{value} {}
+
+        tracked(const tracked& rhs) : value{rhs.value} { ++copies; }
+        tracked(tracked&& rhs) noexcept : value{rhs.value} { ++moves; }
+
+        auto operator=(const tracked& rhs) -> tracked& {
+            value = rhs.value;
+            ++copies;
+            return *this;
+        }
+
+        auto operator=(tracked&& rhs) noexcept -> tracked& {
+            value = rhs.value;
+            ++moves;
+            return *this;
+        }
+
+        int value = 0;
+        inline static auto copies = 0;
+        inline static auto moves = 0;
+    };
+
+    bool operator==(const tracked& lhs, const tracked& rhs) {
+        return lhs.value == rhs.value;
+    }
+
+    using ksr_test::counting_clock;
+}
+
 TEST_CASE("int_percentage_count", "[update_filter]") {
 
     auto update_count = 0;
@@ -48,17 +91,101 @@ TEST_CASE("double_percentage_count", "[update_filter]") {
     CHECK(int_percentage(filter) == 100);
 }
 
+TEST_CASE("fraction_resolution", "[update_filter]") {
+
+    auto per_mille_count = 0;
+    auto per_mille = int_per_mille_filter<unsigned>{[&](unsigned, unsigned) {
+        ++per_mille_count;
+    }};
+
+    auto basis_points_count = 0;
+    auto basis_points = int_basis_points_filter<long>{[&](long, long) {
+        ++basis_points_count;
+    }};
+
+    static constexpr auto max = 100000;
+    for (auto i = 0; i < max; ++i) {
+        per_mille.update(static_cast<unsigned>(i), unsigned{max});
+        basis_points.update(i, long{max});
+    }
+
+    CHECK(per_mille_count == 1001);
+    CHECK(int_fraction(per_mille) == 1000);
+    CHECK(basis_points_count == 10001);
+    CHECK(int_fraction(basis_points) == 10000);
+    CHECK(int_percentage(basis_points.count(), basis_points.total()) == 100);
+}
+
+TEST_CASE("fraction_threshold", "[update_filter]") {
+
+    auto update_count = 0;
+    auto filter = int_percentage_filter<int>{[&](int, int) {
+        ++update_count;
+    }};
+
+    // A sync() that jumps ahead must move the threshold with it, and a change of total must be
+    // judged against the new total rather than the cached threshold.
+
+    CHECK(filter.update(0, 1000));
+    filter.sync(500, 1000);
+    CHECK(!filter.update(501, 1000));
+    CHECK(!filter.update(504, 1000));
+    CHECK(filter.update(505, 1000));
+    CHECK(!filter.update(505, 2000));
+    CHECK(filter.update(505, 500));
+    CHECK(int_percentage(filter) == 101);
+    CHECK(update_count == 4);
+
+    // With no threshold cached (as for a non-positive total), a zero total is judged by the slow
+    // path, which rejects it as it always has, rather than against a stale threshold.
+
+    filter.sync(1, -10);
+#ifdef KSR_THROW_ON_ASSERT
+    CHECK_THROWS_AS(filter.update(600, 0), ksr::logic_error);
+#endif
+}
+
+TEST_CASE("fraction_threshold_changing_total", "[update_filter]") {
+
+    auto filter = int_per_mille_filter<long>{[](long, long) {}};
+
+    // The threshold recomputed for each new total must make the same decisions as comparing
+    // fractions, whether the total grows, shrinks or alternates between updates.
+
+    auto last_fraction = 0;
+    auto mismatches = 0;
+    auto updates = 0;
+    for (auto i = 0L; i < 20000; ++i) {
+
+        const auto total = 5000 + (i / 7) % 300 - (i % 3 == 0 ? 1000 : 0);
+        const auto count = i / 5;
+        const auto expected = i == 0 || int_fraction<1000>(count, total) > last_fraction;
+
+        const auto updated = filter.update(count, total);
+        mismatches += updated != expected;
+        if (updated) {
+            last_fraction = int_fraction<1000>(count, total);
+            ++updates;
+        }
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(updates > 100);
+}
+
 TEST_CASE("sample_count", "[update_filter]") {
 
+    manual_clock::set({});
+
     auto update_count = 0;
-    auto filter = sampled_filter<int>{20ms, [&](int) {
+    auto filter = basic_sampled_filter<manual_clock, int>{20ms, [&](int) {
         ++update_count;
     }};
 
     auto i = 0;
-    const auto start_time = std::chrono::steady_clock::now();
-    while (std::chrono::steady_clock::now() - start_time < 50ms) {
+    while (manual_clock::now().time_since_epoch() < 50ms) {
         filter.update(i++);
+        manual_clock::advance(1ms);
     }
 
     CHECK(update_count == 3);
@@ -73,22 +200,316 @@ TEST_CASE("sample_period", "[update_filter]") {
     static constexpr auto update_period = 5ms;
     static constexpr auto sample_period = 20ms;
 
+    manual_clock::set({});
+
     auto update_count = 0;
     auto value = 0;
-    auto filter = sampled_filter<int>{sample_period, [&](const int new_value) {
+    auto filter = basic_sampled_filter<manual_clock, int>{sample_period, [&](const int new_value) {
         ++update_count;
         value = new_value;
     }};
 
     for (int i = 0; i < final_value; ++i) {
         filter.update(i);
-        std::this_thread::sleep_for(update_period);
+        manual_clock::advance(update_period);
     }
 
     static constexpr auto max_updates = final_value * update_period / sample_period + 1;
-    CHECK(update_count <= max_updates);
+    CHECK(update_count == max_updates);
     CHECK(value == final_value - 1);
 
     filter.sync(final_value);
     CHECK(value == final_value);
 }
+
+TEST_CASE("sample_sync", "[update_filter]") {
+
+    manual_clock::set({});
+
+    auto filter = basic_sampled_filter<manual_clock, int>{20ms, [](int) {}};
+
+    // sync() restarts the interval, as an accepted update does.
+
+    CHECK(filter.update(1));
+    manual_clock::advance(30ms);
+    filter.sync(2);
+    manual_clock::advance(10ms);
+    CHECK_FALSE(filter.update(3));
+    manual_clock::advance(10ms);
+    CHECK(filter.update(3));
+}
+
+TEST_CASE("sample_every_nth", "[update_filter]") {
+
+    manual_clock::set({});
+
+    auto update_count = 0;
+    auto filter = basic_sampled_filter<every_nth_clock<manual_clock, 4>, int>{10ms, [&](int) {
+        ++update_count;
+    }};
+
+    // The clock is only read on the 1st, 5th and 9th calls (at 0ms, 20ms and 40ms), so each update
+    // that falls due 10ms after the last is deferred until the next read.
+
+    for (auto i = 1; i <= 12; ++i) {
+        filter.update(i);
+        manual_clock::advance(5ms);
+    }
+
+    CHECK(update_count == 3);
+}
+
+TEST_CASE("adaptive_rate_count", "[update_filter]") {
+
+    // Jobs of the same duration notify at the same rate, however fast their items arrive, and
+    // the fast job reads the clock only a little more often than it notifies.
+
+    const auto run_job = [](const std::int64_t total, const std::chrono::microseconds item_time) {
+
+        manual_clock::set({});
+        counting_clock::reads = 0;
+
+        auto update_count = 0;
+        auto filter = basic_adaptive_rate_filter<counting_clock, std::int64_t>{100ms,
+            [&](std::int64_t, std::int64_t) { ++update_count; }};
+
+        for (auto i = std::int64_t{0}; i <= total; ++i) {
+            filter.update(i, total);
+            manual_clock::advance(item_time);
+        }
+
+        CHECK(ksr::get<0>(filter) == total);
+        CHECK(counting_clock::reads < 2 * update_count);
+        return update_count;
+    };
+
+    const auto fast_updates = run_job(1000000, 2us);
+    const auto slow_updates = run_job(200, 10000us);
+
+    CHECK(fast_updates >= 18);
+    CHECK(fast_updates <= 24);
+    CHECK(slow_updates >= 18);
+    CHECK(slow_updates <= 24);
+}
+
+TEST_CASE("adaptive_rate_eta", "[update_filter]") {
+
+    static constexpr auto total = std::int64_t{5000};
+
+    manual_clock::set({});
+
+    auto update_count = 0;
+    auto throughput = 0.0;
+    auto eta = std::optional<std::chrono::duration<double>>{};
+
+    auto filter = basic_update_filter{
+        update_filter_tag<filter_policy::basic_adaptive_rate<manual_clock>::policy, std::int64_t, std::int64_t>{}, 200ms,
+        [&](const std::int64_t, const std::int64_t, const filter_policy::rate_estimate& rate) {
+            ++update_count;
+            throughput = rate.throughput;
+            eta = rate.eta;
+        }};
+
+    // One item per millisecond, with the rate reported to the callback of every update but the
+    // first.
+
+    for (auto i = std::int64_t{0}; i < 1000; ++i) {
+        filter.update(i, total);
+        manual_clock::advance(1ms);
+        CHECK((update_count <= 1 || throughput == Approx(1000.0)));
+    }
+
+    REQUIRE(eta);
+    CHECK(eta->count() == Approx((total - ksr::get<0>(filter)) / 1000.0));
+
+    // A doubling of the rate shows up in the moving average, and so in the estimate.
+
+    for (auto i = std::int64_t{1000}; i < total; i += 2) {
+        filter.update(i, total);
+        manual_clock::advance(1ms);
+    }
+
+    CHECK(throughput > 1800.0);
+    CHECK(throughput <= 2000.0);
+
+    // The update that completes the job is always actioned, immediately.
+
+    const auto previous_count = update_count;
+    filter.update(total, total);
+    CHECK(update_count == previous_count + 1);
+    CHECK(eta->count() == 0.0);
+
+    // The estimate given to the callback is the one the filter reports.
+
+    CHECK(filter.throughput() == throughput);
+    CHECK(filter.eta() == eta);
+
+    // Callbacks that take only the data are still given only the data.
+
+    auto plain_updates = 0;
+    auto plain = basic_adaptive_rate_filter<manual_clock, std::int64_t>{200ms,
+        [&](const std::int64_t, const std::int64_t) { ++plain_updates; }};
+    plain.update(0, total);
+    CHECK(plain_updates == 1);
+}
+
+TEST_CASE("delta_threshold", "[update_filter]") {
+
+    auto update_count = 0;
+    auto filter = delta_filter<float, double, int>{delta_threshold{0.5, 0.1},
+        [&](float, double, int) { ++update_count; }};
+
+    filter.update(0.0f, 0.0, 0);
+    CHECK(update_count == 0);
+
+    // Each element is compared against its own last-actioned value, so slow drift accumulates
+    // until it becomes significant.
+
+    filter.update(0.3f, 0.0, 0);
+    filter.update(0.5f, 0.0, 0);
+    CHECK(update_count == 0);
+    filter.update(0.6f, 0.0, 0);
+    CHECK(update_count == 1);
+
+    filter.update(0.6f, -0.6, 0);
+    CHECK(update_count == 2);
+
+    filter.update(0.6f, -0.6, 1);
+    CHECK(update_count == 3);
+
+    // The tolerance grows with the magnitude of the last-actioned value.
+
+    filter.update(100.0f, -0.6, 1);
+    CHECK(update_count == 4);
+    filter.update(110.0f, -0.6, 1);
+    CHECK(update_count == 4);
+    filter.update(111.0f, -0.6, 1);
+    CHECK(update_count == 5);
+
+    const auto [position, rate, level] = filter;
+    CHECK(position == 111.0f);
+    CHECK(rate == -0.6);
+    CHECK(level == 1);
+}
+
+TEST_CASE("snapshot_reads", "[update_filter]") {
+
+    static constexpr auto total = std::int64_t{2000000};
+
+    // The policy is applied as usual, and the inner policy's accessors still work.
+
+    auto update_count = 0;
+    auto filter = snapshot_update_filter<filter_policy::int_percentage, std::int64_t, std::int64_t>{
+        [&](std::int64_t, std::int64_t) { ++update_count; }};
+
+    for (auto i = std::int64_t{0}; i < 1000; ++i) {
+        filter.update(i, 1000);
+    }
+
+    CHECK(update_count == 101);
+    CHECK(filter.count() == 995);
+    CHECK((filter.snapshot() == std::tuple{std::int64_t{995}, std::int64_t{1000}}));
+
+    const auto [count, total_read] = filter;
+    CHECK(count == 995);
+    CHECK(total_read == 1000);
+
+    // A reader on another thread never observes data from two different updates.
+
+    filter.sync(0, total);
+    auto writer = std::thread{[&] {
+        for (auto i = std::int64_t{0}; i <= total; ++i) {
+            filter.sync(i, total + i);
+        }
+    }};
+
+    auto consistent = true;
+    auto last = std::int64_t{0};
+    while (last < total) {
+        const auto [done, sum] = filter.snapshot();
+        consistent = consistent && sum == total + done && done >= last;
+        last = done;
+    }
+
+    writer.join();
+    CHECK(consistent);
+}
+
+TEST_CASE("deduced_callback", "[update_filter]") {
+
+    auto update_count = 0;
+    auto filter = basic_update_filter{
+        update_filter_tag<filter_policy::int_percentage, int, int>{},
+        [&](int, int) { ++update_count; }};
+
+    static_assert(!std::is_same_v<decltype(filter), int_percentage_filter<int>>);
+
+    static constexpr auto max = 1000;
+    for (auto i = 0; i < max; ++i) {
+        filter.update(i, max);
+    }
+
+    CHECK(update_count == 101);
+    CHECK(int_percentage(filter) == 100);
+
+    const auto [count, total] = filter;
+    CHECK(count == 995);
+    CHECK(total == max);
+}
+
+TEST_CASE("inplace_callback", "[update_filter]") {
+
+    auto update_count = 0;
+    auto last_value = 0;
+    using policy = filter_policy::basic_sampled<manual_clock>;
+
+    manual_clock::set({});
+    auto filter = inplace_update_filter<policy::policy, int>{1s, [&](const int value) {
+        ++update_count;
+        last_value = value;
+    }};
+
+    filter.update(1);
+    filter.update(2);
+    CHECK(update_count == 1);
+    CHECK(last_value == 1);
+
+    auto copy = filter;
+    copy.sync(3);
+    CHECK(update_count == 2);
+    CHECK(last_value == 3);
+    CHECK(get<0>(filter) == 1);
+}
+
+TEST_CASE("update_copies", "[update_filter]") {
+
+    manual_clock::set({});
+
+    auto last_value = 0;
+    auto filter = basic_update_filter{
+        update_filter_tag<filter_policy::basic_sampled<manual_clock>::policy, tracked>{}, 10ms,
+        [&](const tracked& value) { last_value = value.value; }};
+
+    tracked::copies = 0;
+    tracked::moves = 0;
+
+    const auto first = tracked{1};
+    CHECK(filter.update(first));
+    CHECK(tracked::copies == 1);
+
+    CHECK(!filter.update(first));
+    CHECK(!filter.update(tracked{2}));
+    CHECK(tracked::copies == 1);
+    CHECK(tracked::moves == 0);
+
+    manual_clock::advance(10ms);
+    CHECK(filter.update(tracked{3}));
+    CHECK(tracked::copies == 1);
+    CHECK(tracked::moves == 1);
+
+    filter.sync(tracked{4});
+    CHECK(tracked::copies == 1);
+    CHECK(tracked::moves == 2);
+    CHECK(last_value == 4);
+    CHECK(get<0>(filter).value == 4);
+}